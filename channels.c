@@ -83,6 +83,10 @@ cChannel::cChannel(const cChannel &Channel)
 
 cChannel::~cChannel()
 {
+  if (number > 0 && number < Channels.channelsByNumber.Size() && Channels.channelsByNumber[number] == this) {
+     Channels.channelsByNumber[number] = NULL;
+     Channels.UnhashChannel(this);
+     }
   delete linkChannels;
   linkChannels = NULL; // more than one channel can link to this one, so we need the following loop
   for (cChannel *Channel = Channels.First(); Channel; Channel = Channels.Next(Channel)) {
@@ -795,6 +799,14 @@ cChannels::cChannels(void)
   maxChannelNameLength = 0;
   maxShortChannelNameLength = 0;
   modified = CHANNELSMOD_NONE;
+  updating = 0;
+  renumber = false;
+  SetIndexed();
+}
+
+cChannels::~cChannels()
+{
+  cList<cChannel>::Clear(); // the channels access channelsByNumber when they are deleted
 }
 
 void cChannels::DeleteDuplicateChannels(void)
@@ -871,6 +883,7 @@ int cChannels::GetPrevNormal(int Idx)
 void cChannels::ReNumber(void)
 {
   channelsHashSid.Clear();
+  channelsByNumber.Clear();
   maxNumber = 0;
   int Number = 1;
   for (cChannel *channel = First(); channel; channel = Next(channel)) {
@@ -881,6 +894,7 @@ void cChannels::ReNumber(void)
       else {
          HashChannel(channel);
          maxNumber = Number;
+         channelsByNumber[Number] = channel; // the gaps are initialized with NULL
          channel->SetNumber(Number++);
          }
       }
@@ -888,58 +902,56 @@ void cChannels::ReNumber(void)
 
 cChannel *cChannels::GetByNumber(int Number, int SkipGap)
 {
-  cChannel *previous = NULL;
-  for (cChannel *channel = First(); channel; channel = Next(channel)) {
-      if (!channel->GroupSep()) {
-         if (channel->Number() == Number)
-            return channel;
-         else if (SkipGap && channel->Number() > Number)
-            return SkipGap > 0 ? channel : previous;
-         previous = channel;
+  if (Number > maxNumber)
+     return NULL;
+  if (Number > 0 && channelsByNumber[Number])
+     return channelsByNumber[Number];
+  if (SkipGap > 0) {
+     for (int n = max(Number + 1, 1); n <= maxNumber; n++) {
+         if (channelsByNumber[n])
+            return channelsByNumber[n];
          }
-      }
+     }
+  else if (SkipGap < 0) {
+     for (int n = Number - 1; n > 0; n--) {
+         if (channelsByNumber[n])
+            return channelsByNumber[n];
+         }
+     }
   return NULL;
 }
 
 cChannel *cChannels::GetByServiceID(int Source, int Transponder, unsigned short ServiceID)
 {
-  cList<cHashObject> *list = channelsHashSid.GetList(ServiceID);
-  if (list) {
-     for (cHashObject *hobj = list->First(); hobj; hobj = list->Next(hobj)) {
-         cChannel *channel = (cChannel *)hobj->Object();
-         if (channel->Sid() == ServiceID && channel->Source() == Source && ISTRANSPONDER(channel->Transponder(), Transponder))
-            return channel;
-         }
-     }
+  int Slot;
+  for (cChannel *channel = channelsHashSid.First(ServiceID, Slot); channel; channel = channelsHashSid.Next(ServiceID, Slot)) {
+      if (channel->Sid() == ServiceID && channel->Source() == Source && ISTRANSPONDER(channel->Transponder(), Transponder))
+         return channel;
+      }
   return NULL;
 }
 
 cChannel *cChannels::GetByChannelID(tChannelID ChannelID, bool TryWithoutRid, bool TryWithoutPolarization)
 {
   int sid = ChannelID.Sid();
-  cList<cHashObject> *list = channelsHashSid.GetList(sid);
-  if (list) {
-     for (cHashObject *hobj = list->First(); hobj; hobj = list->Next(hobj)) {
-         cChannel *channel = (cChannel *)hobj->Object();
-         if (channel->Sid() == sid && channel->GetChannelID() == ChannelID)
+  int Slot;
+  for (cChannel *channel = channelsHashSid.First(sid, Slot); channel; channel = channelsHashSid.Next(sid, Slot)) {
+      if (channel->Sid() == sid && channel->GetChannelID() == ChannelID)
+         return channel;
+      }
+  if (TryWithoutRid) {
+     ChannelID.ClrRid();
+     for (cChannel *channel = channelsHashSid.First(sid, Slot); channel; channel = channelsHashSid.Next(sid, Slot)) {
+         if (channel->Sid() == sid && channel->GetChannelID().ClrRid() == ChannelID)
+            return channel;
+         }
+     }
+  if (TryWithoutPolarization) {
+     ChannelID.ClrPolarization();
+     for (cChannel *channel = channelsHashSid.First(sid, Slot); channel; channel = channelsHashSid.Next(sid, Slot)) {
+         if (channel->Sid() == sid && channel->GetChannelID().ClrPolarization() == ChannelID)
             return channel;
          }
-     if (TryWithoutRid) {
-        ChannelID.ClrRid();
-        for (cHashObject *hobj = list->First(); hobj; hobj = list->Next(hobj)) {
-            cChannel *channel = (cChannel *)hobj->Object();
-            if (channel->Sid() == sid && channel->GetChannelID().ClrRid() == ChannelID)
-               return channel;
-            }
-        }
-     if (TryWithoutPolarization) {
-        ChannelID.ClrPolarization();
-        for (cHashObject *hobj = list->First(); hobj; hobj = list->Next(hobj)) {
-            cChannel *channel = (cChannel *)hobj->Object();
-            if (channel->Sid() == sid && channel->GetChannelID().ClrPolarization() == ChannelID)
-               return channel;
-            }
-        }
      }
   return NULL;
 }
@@ -958,8 +970,9 @@ cChannel *cChannels::GetByTransponderID(tChannelID ChannelID)
 bool cChannels::HasUniqueChannelID(cChannel *NewChannel, cChannel *OldChannel)
 {
   tChannelID NewChannelID = NewChannel->GetChannelID();
-  for (cChannel *channel = First(); channel; channel = Next(channel)) {
-      if (!channel->GroupSep() && channel != OldChannel && channel->GetChannelID() == NewChannelID)
+  int Slot;
+  for (cChannel *channel = channelsHashSid.First(NewChannelID.Sid(), Slot); channel; channel = channelsHashSid.Next(NewChannelID.Sid(), Slot)) {
+      if (channel != OldChannel && channel->GetChannelID() == NewChannelID)
          return false;
       }
   return true;
@@ -971,6 +984,19 @@ bool cChannels::SwitchTo(int Number)
   return channel && cDevice::PrimaryDevice()->SwitchChannel(channel, true);
 }
 
+void cChannels::BeginUpdate(void)
+{
+  updating++;
+}
+
+void cChannels::EndUpdate(void)
+{
+  if (updating > 0 && --updating == 0 && renumber) {
+     ReNumber();
+     renumber = false;
+     }
+}
+
 int cChannels::MaxChannelNameLength(void)
 {
   if (!maxChannelNameLength) {
@@ -1015,7 +1041,30 @@ cChannel *cChannels::NewChannel(const cChannel *Transponder, const char *Name, c
      NewChannel->SetId(Nid, Tid, Sid, Rid);
      NewChannel->SetName(Name, ShortName, Provider);
      Add(NewChannel);
-     ReNumber();
+     // The new channel is the last one in the list, so it gets the number following
+     // the last numbered channel (or a trailing group separator's '@' number):
+     int Number = maxNumber + 1;
+     cChannel *channel = Prev(NewChannel);
+     while (channel && channel->GroupSep()) {
+           if (channel->Number() > Number)
+              Number = channel->Number();
+           channel = Prev(channel);
+           }
+     if (channel && channel->Number() != maxNumber) {
+        // the numbers are not up to date, so we need to do it the hard way
+        if (updating) {
+           HashChannel(NewChannel); // makes sure we don't create it again before EndUpdate()
+           renumber = true;
+           }
+        else
+           ReNumber();
+        }
+     else {
+        HashChannel(NewChannel);
+        maxNumber = Number;
+        channelsByNumber[Number] = NewChannel;
+        NewChannel->SetNumber(Number);
+        }
      return NewChannel;
      }
   return NULL;
@@ -200,16 +200,21 @@ public:
   };
 
 class cChannels : public cRwLock, public cConfig<cChannel> {
+  friend class cChannel;
 private:
   int maxNumber;
   int maxChannelNameLength;
   int maxShortChannelNameLength;
   int modified;
   int beingEdited;
-  cHash<cChannel> channelsHashSid;
+  int updating;
+  bool renumber;
+  cOpenHash<cChannel> channelsHashSid;
+  cVector<cChannel *> channelsByNumber; // as set up by ReNumber(), NULL for numbers that are skipped by group separators
   void DeleteDuplicateChannels(void);
 public:
   cChannels(void);
+  virtual ~cChannels();
   bool Load(const char *FileName, bool AllowComments = false, bool MustExist = false);
   void HashChannel(cChannel *Channel);
   void UnhashChannel(cChannel *Channel);
@@ -226,6 +231,8 @@ public:
   void IncBeingEdited(void) { beingEdited++; }
   void DecBeingEdited(void) { beingEdited--; }
   bool HasUniqueChannelID(cChannel *NewChannel, cChannel *OldChannel = NULL);
+      ///< Checks whether NewChannel has a channel id that is not already used by
+      ///< any channel in this list, except OldChannel.
   bool SwitchTo(int Number);
   int MaxNumber(void) { return maxNumber; }
   int MaxChannelNameLength(void);
@@ -236,6 +243,15 @@ public:
       ///< modification has been made, and 2 if the user has made a modification.
       ///< Calling this function resets the 'modified' flag to 0.
   cChannel *NewChannel(const cChannel *Transponder, const char *Name, const char *ShortName, const char *Provider, int Nid, int Tid, int Sid, int Rid = 0);
+      ///< Creates a new channel on the given Transponder and appends it to the list.
+      ///< The new channel is numbered incrementally, without a full ReNumber().
+  void BeginUpdate(void);
+      ///< Starts a batch of automatic modifications, as done by the SDT and NIT
+      ///< filters while scanning. If a full ReNumber() becomes necessary within
+      ///< the batch, it is done only once, in the matching call to EndUpdate().
+      ///< Calls may be nested. The caller must hold a write lock on the channels.
+  void EndUpdate(void);
+      ///< Ends a batch of modifications started with BeginUpdate().
   };
 
 extern cChannels Channels;
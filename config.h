@@ -27,8 +27,8 @@
 
 // The plugin API's version number:
 
-#define APIVERSION  "2.0.0"
-#define APIVERSNUM   20000  // Version * 10000 + Major * 100 + Minor
+#define APIVERSION  "2.0.1"
+#define APIVERSNUM   20001  // Version * 10000 + Major * 100 + Minor
 
 // When loading plugins, VDR searches them by their APIVERSION, which
 // may be smaller than VDRVERSION in case there have been no changes to
@@ -280,6 +280,7 @@ public:
   int EPGScanTimeout;
   int EPGBugfixLevel;
   int EPGLinger;
+  int EPGIncrementalWrite;
   int SVDRPTimeout;
   int ZapTimeout;
   int ChannelEntryTimeout;
@@ -83,6 +83,7 @@ cDevice::cDevice(void)
 
   sectionHandler = NULL;
   eitFilter = NULL;
+  tdtFilter = NULL;
   patFilter = NULL;
   sdtFilter = NULL;
   nitFilter = NULL;
@@ -571,6 +572,7 @@ void cDevice::StartSectionHandler(void)
   if (!sectionHandler) {
      sectionHandler = new cSectionHandler(this);
      AttachFilter(eitFilter = new cEitFilter);
+     AttachFilter(tdtFilter = new cTdtFilter);
      AttachFilter(patFilter = new cPatFilter);
      AttachFilter(sdtFilter = new cSdtFilter(patFilter));
      AttachFilter(nitFilter = new cNitFilter);
@@ -583,11 +585,13 @@ void cDevice::StopSectionHandler(void)
      delete nitFilter;
      delete sdtFilter;
      delete patFilter;
+     delete tdtFilter;
      delete eitFilter;
      delete sectionHandler;
      nitFilter = NULL;
      sdtFilter = NULL;
      patFilter = NULL;
+     tdtFilter = NULL;
      eitFilter = NULL;
      sectionHandler = NULL;
      }
@@ -376,6 +376,7 @@ public:
 private:
   cSectionHandler *sectionHandler;
   cEitFilter *eitFilter;
+  cTdtFilter *tdtFilter;
   cPatFilter *patFilter;
   cSdtFilter *sdtFilter;
   cNitFilter *nitFilter;
@@ -710,6 +710,72 @@ void cDvbSubtitleAssembler::Put(const uchar *Data, int Length)
      }
 }
 
+// --- cScaledBitmap ---------------------------------------------------------
+
+// Subtitle streams typically show the same regions on several consecutive
+// pages, so the most recently scaled bitmaps are kept and used again as long
+// as their contents and the scaling factors are the same:
+
+#define MAXSCALEDBITMAPS MAXOSDAREAS
+
+class cScaledBitmap : public cListObject {
+private:
+  int width;
+  int height;
+  int bpp;
+  int x0;
+  int y0;
+  tIndex *data;
+  tColor colors[MAXNUMCOLORS];
+  int numColors;
+  double factorX;
+  double factorY;
+  bool antiAlias;
+  cBitmap *scaled;
+public:
+  cScaledBitmap(cBitmap *Bitmap, double FactorX, double FactorY, bool AntiAlias);
+  virtual ~cScaledBitmap();
+  bool Matches(const cBitmap *Bitmap, double FactorX, double FactorY, bool AntiAlias) const;
+  const cBitmap *Scaled(void) const { return scaled; }
+  };
+
+cScaledBitmap::cScaledBitmap(cBitmap *Bitmap, double FactorX, double FactorY, bool AntiAlias)
+{
+  width = Bitmap->Width();
+  height = Bitmap->Height();
+  bpp = Bitmap->Bpp();
+  x0 = Bitmap->X0();
+  y0 = Bitmap->Y0();
+  data = MALLOC(tIndex, width * height);
+  memcpy(data, Bitmap->Data(0, 0), width * height);
+  const tColor *Colors = Bitmap->Colors(numColors);
+  if (Colors)
+     memcpy(colors, Colors, numColors * sizeof(tColor));
+  factorX = FactorX;
+  factorY = FactorY;
+  antiAlias = AntiAlias;
+  scaled = Bitmap->Scaled(FactorX, FactorY, AntiAlias);
+}
+
+cScaledBitmap::~cScaledBitmap()
+{
+  free(data);
+  delete scaled;
+}
+
+bool cScaledBitmap::Matches(const cBitmap *Bitmap, double FactorX, double FactorY, bool AntiAlias) const
+{
+  if (Bitmap->Width() != width || Bitmap->Height() != height || Bitmap->Bpp() != bpp || Bitmap->X0() != x0 || Bitmap->Y0() != y0)
+     return false;
+  if (FactorX != factorX || FactorY != factorY || AntiAlias != antiAlias)
+     return false;
+  int NumColors;
+  const tColor *Colors = Bitmap->Colors(NumColors);
+  if (NumColors != numColors || Colors && memcmp(Colors, colors, numColors * sizeof(tColor)) != 0)
+     return false;
+  return memcmp(Bitmap->Data(0, 0), data, width * height) == 0;
+}
+
 // --- cDvbSubtitleBitmaps ---------------------------------------------------
 
 class cDvbSubtitleBitmaps : public cListObject {
@@ -720,14 +786,24 @@ private:
   int numAreas;
   double osdFactorX;
   double osdFactorY;
+  bool scale;
+  bool antiAlias;
+  bool prepared;
   cVector<cBitmap *> bitmaps;
+  const cBitmap *ScaledBitmap(int Index, cList<cScaledBitmap> *ScaledBitmaps);
 public:
   cDvbSubtitleBitmaps(int64_t Pts, int Timeout, tArea *Areas, int NumAreas, double OsdFactorX, double OsdFactorY);
   ~cDvbSubtitleBitmaps();
   int64_t Pts(void) { return pts; }
   int Timeout(void) { return timeout; }
+  bool Prepared(void) { return prepared; }
   void AddBitmap(cBitmap *Bitmap);
-  void Draw(cOsd *Osd);
+  void Prepare(cList<cScaledBitmap> *ScaledBitmaps);
+       ///< Does everything that can be done before the bitmaps are actually due
+       ///< to be displayed, which is scaling them to the size of the OSD. This
+       ///< doesn't require the OSD to exist yet. The scaled bitmaps are kept in
+       ///< ScaledBitmaps.
+  void Draw(cOsd *Osd, cList<cScaledBitmap> *ScaledBitmaps);
   };
 
 cDvbSubtitleBitmaps::cDvbSubtitleBitmaps(int64_t Pts, int Timeout, tArea *Areas, int NumAreas, double OsdFactorX, double OsdFactorY)
@@ -738,6 +814,9 @@ cDvbSubtitleBitmaps::cDvbSubtitleBitmaps(int64_t Pts, int Timeout, tArea *Areas,
   numAreas = NumAreas;
   osdFactorX = OsdFactorX;
   osdFactorY = OsdFactorY;
+  scale = !(DoubleEqual(osdFactorX, 1.0) && DoubleEqual(osdFactorY, 1.0));
+  antiAlias = true;
+  prepared = false;
 }
 
 cDvbSubtitleBitmaps::~cDvbSubtitleBitmaps()
@@ -752,11 +831,43 @@ void cDvbSubtitleBitmaps::AddBitmap(cBitmap *Bitmap)
   bitmaps.Append(Bitmap);
 }
 
-void cDvbSubtitleBitmaps::Draw(cOsd *Osd)
+const cBitmap *cDvbSubtitleBitmaps::ScaledBitmap(int Index, cList<cScaledBitmap> *ScaledBitmaps)
 {
-  bool Scale = !(DoubleEqual(osdFactorX, 1.0) && DoubleEqual(osdFactorY, 1.0));
-  bool AntiAlias = true;
-  if (Scale && osdFactorX > 1.0 || osdFactorY > 1.0) {
+  cBitmap *b = bitmaps[Index];
+  cScaledBitmap *sb = ScaledBitmaps->First();
+  while (sb && !sb->Matches(b, osdFactorX, osdFactorY, antiAlias))
+        sb = ScaledBitmaps->Next(sb);
+  if (sb) {
+     if (sb != ScaledBitmaps->First()) {
+        ScaledBitmaps->Del(sb, false);
+        ScaledBitmaps->Ins(sb);
+        }
+     }
+  else {
+     sb = new cScaledBitmap(b, osdFactorX, osdFactorY, antiAlias);
+     ScaledBitmaps->Ins(sb);
+     while (ScaledBitmaps->Count() > MAXSCALEDBITMAPS)
+           ScaledBitmaps->Del(ScaledBitmaps->Last());
+     }
+  return sb->Scaled();
+}
+
+void cDvbSubtitleBitmaps::Prepare(cList<cScaledBitmap> *ScaledBitmaps)
+{
+  if (prepared)
+     return;
+  // The bitmaps are scaled with anti-aliasing, which nearly all OSDs can handle
+  // (if the actual OSD can't, Draw() scales them again without it):
+  if (scale) {
+     for (int i = 0; i < bitmaps.Size(); i++)
+         ScaledBitmap(i, ScaledBitmaps);
+     }
+  prepared = true;
+}
+
+void cDvbSubtitleBitmaps::Draw(cOsd *Osd, cList<cScaledBitmap> *ScaledBitmaps)
+{
+  if (scale && osdFactorX > 1.0 || osdFactorY > 1.0) {
      // Upscaling requires 8bpp:
      int Bpp[MAXOSDAREAS];
      for (int i = 0; i < numAreas; i++) {
@@ -766,17 +877,13 @@ void cDvbSubtitleBitmaps::Draw(cOsd *Osd)
      if (Osd->CanHandleAreas(areas, numAreas) != oeOk) {
         for (int i = 0; i < numAreas; i++)
             Bpp[i] = areas[i].bpp = Bpp[i];
-        AntiAlias = false;
+        antiAlias = false;
         }
      }
   if (Osd->SetAreas(areas, numAreas) == oeOk) {
      for (int i = 0; i < bitmaps.Size(); i++) {
-         cBitmap *b = bitmaps[i];
-         if (Scale)
-            b = b->Scaled(osdFactorX, osdFactorY, AntiAlias);
+         const cBitmap *b = scale ? ScaledBitmap(i, ScaledBitmaps) : bitmaps[i];
          Osd->DrawBitmap(int(round(b->X0() * osdFactorX)), int(round(b->Y0() * osdFactorY)), *b);
-         if (b != bitmaps[i])
-            delete b;
          }
      Osd->Flush();
      }
@@ -799,15 +906,23 @@ cDvbSubtitleConverter::cDvbSubtitleConverter(void)
   windowVerticalOffset = 0;
   pages = new cList<cDvbSubtitlePage>;
   bitmaps = new cList<cDvbSubtitleBitmaps>;
+  scaledBitmaps = new cList<cScaledBitmap>;
+  shownPages = 0;
+  totalDelay = 0;
+  maxDelay = 0;
   Start();
 }
 
 cDvbSubtitleConverter::~cDvbSubtitleConverter()
 {
+  Cancel(-1);
+  wakeup.Signal();
   Cancel(3);
+  LogDelays();
   delete dvbSubtitleAssembler;
   delete osd;
   delete bitmaps;
+  delete scaledBitmaps;
   delete pages;
 }
 
@@ -823,6 +938,8 @@ void cDvbSubtitleConverter::Reset(void)
   Lock();
   pages->Clear();
   bitmaps->Clear();
+  scaledBitmaps->Clear();
+  LogDelays();
   DELETENULL(osd);
   frozen = false;
   ddsVersionNumber = -1;
@@ -943,23 +1060,51 @@ void cDvbSubtitleConverter::Action(void)
                  if (Delta <= 0) {
                     dbgconverter("Got %d bitmaps, showing #%d\n", bitmaps->Count(), sb->Index() + 1);
                     if (AssertOsd()) {
-                       sb->Draw(osd);
+                       cTimeMs DrawTime;
+                       sb->Draw(osd, scaledBitmaps);
                        Timeout.Set(sb->Timeout() * 1000);
+                       RecordDelay(int(DrawTime.Elapsed() - Delta));
                        dbgconverter("PTS: %"PRId64"  STC: %"PRId64" (%"PRId64") timeout: %d\n", sb->Pts(), cDevice::PrimaryDevice()->GetSTC(), Delta, sb->Timeout());
                        }
                     bitmaps->Del(sb);
                     }
-                 else if (Delta < WaitMs)
-                    WaitMs = Delta;
+                 else {
+                    if (!sb->Prepared()) {
+                       // Scale the bitmaps now, so that they can be displayed
+                       // right away once they are due:
+                       cTimeMs PrepareTime;
+                       sb->Prepare(scaledBitmaps);
+                       Delta -= PrepareTime.Elapsed();
+                       }
+                    if (Delta < WaitMs)
+                       WaitMs = max(int(Delta), 1);
+                    }
                  }
               else
                  bitmaps->Del(sb);
               }
            }
-        cCondWait::SleepMs(WaitMs);
+        wakeup.Wait(WaitMs);
         }
 }
 
+void cDvbSubtitleConverter::RecordDelay(int Delay)
+{
+  shownPages++;
+  totalDelay += Delay;
+  if (Delay > maxDelay)
+     maxDelay = Delay;
+}
+
+void cDvbSubtitleConverter::LogDelays(void)
+{
+  if (shownPages)
+     dsyslog("subtitles: %d pages shown, average delay %d ms, maximum delay %d ms", shownPages, int(totalDelay / shownPages), maxDelay);
+  shownPages = 0;
+  totalDelay = 0;
+  maxDelay = 0;
+}
+
 tColor cDvbSubtitleConverter::yuv2rgb(int Y, int Cb, int Cr)
 {
   int Ey, Epb, Epr;
@@ -1281,7 +1426,6 @@ void cDvbSubtitleConverter::FinishPage(cDvbSubtitlePage *Page)
            return; // unable to draw bitmaps
         }
   cDvbSubtitleBitmaps *Bitmaps = new cDvbSubtitleBitmaps(Page->Pts(), Page->Timeout(), Areas, NumAreas, osdFactorX, osdFactorY);
-  bitmaps->Add(Bitmaps);
   for (int i = 0; i < NumAreas; i++) {
       cSubtitleRegion *sr = Page->regions.Get(i);
       cSubtitleClut *clut = Page->GetClutById(sr->ClutId());
@@ -1313,4 +1457,8 @@ void cDvbSubtitleConverter::FinishPage(cDvbSubtitlePage *Page)
          Bitmaps->AddBitmap(bm);
          }
       }
+  Lock();
+  bitmaps->Add(Bitmaps);
+  Unlock();
+  wakeup.Signal(); // lets Action() prepare the new bitmaps and wait for their PTS
 }
@@ -19,6 +19,7 @@
 class cDvbSubtitlePage;
 class cDvbSubtitleAssembler; // for legacy PES recordings
 class cDvbSubtitleBitmaps;
+class cScaledBitmap;
 
 class cDvbSubtitleConverter : public cThread {
 private:
@@ -39,6 +40,16 @@ private:
   double osdFactorY;
   cList<cDvbSubtitlePage> *pages;
   cList<cDvbSubtitleBitmaps> *bitmaps;
+  cList<cScaledBitmap> *scaledBitmaps;
+  cCondWait wakeup;
+  int shownPages;
+  int64_t totalDelay;
+  int maxDelay;
+  void RecordDelay(int Delay);
+       ///< Records the Delay (in ms) with which a page was actually displayed
+       ///< after its PTS.
+  void LogDelays(void);
+       ///< Logs the statistics of the recorded delays and resets them.
   tColor yuv2rgb(int Y, int Cb, int Cr);
   void SetOsdData(void);
   bool AssertOsd(void);
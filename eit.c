@@ -366,8 +366,8 @@ time_t cEitFilter::disableUntil = 0;
 
 cEitFilter::cEitFilter(void)
 {
+  SetQueued(true); // EIT processing may have to wait for the schedules lock, which shall not delay the other filters
   Set(0x12, 0x40, 0xC0);  // event info now&next actual/other TS (0x4E/0x4F), future actual/other TS (0x5X/0x6X)
-  Set(0x14, 0x70);        // TDT
 }
 
 void cEitFilter::SetDisableUntil(time_t Time)
@@ -403,11 +403,23 @@ void cEitFilter::Process(u_short Pid, u_char Tid, const u_char *Data, int Length
             }
          }
          break;
-    case 0x14: {
-         if (Setup.SetSystemTime && Setup.TimeTransponder && ISTRANSPONDER(Transponder(), Setup.TimeTransponder))
-            cTDT TDT(Data);
-         }
-         break;
     default: ;
     }
 }
+
+// --- cTdtFilter ------------------------------------------------------------
+
+// The TDT is handled by a filter of its own, because the EIT filter is queued,
+// and the system time shall not be set from a section that has been waiting
+// behind a lot of EIT data.
+
+cTdtFilter::cTdtFilter(void)
+{
+  Set(0x14, 0x70);        // TDT
+}
+
+void cTdtFilter::Process(u_short Pid, u_char Tid, const u_char *Data, int Length)
+{
+  if (Setup.SetSystemTime && Setup.TimeTransponder && ISTRANSPONDER(Transponder(), Setup.TimeTransponder))
+     cTDT TDT(Data);
+}
@@ -22,4 +22,11 @@ public:
   static void SetDisableUntil(time_t Time);
   };
 
+class cTdtFilter : public cFilter {
+protected:
+  virtual void Process(u_short Pid, u_char Tid, const u_char *Data, int Length);
+public:
+  cTdtFilter(void);
+  };
+
 #endif //__EIT_H
@@ -19,6 +19,189 @@
 
 #define RUNNINGSTATUSTIMEOUT 30 // seconds before the running status is considered unknown
 #define EPGDATAWRITEDELTA   600 // seconds between writing the epg.data file
+#define EPGDATACOMPACTRATIO   2 // incremental dumps may let the epg.data file grow to this multiple of its last full size
+
+// --- cEventTextPool --------------------------------------------------------
+
+// The texts of EPG events are stored only once, no matter how many events
+// share them (like the episodes of a series that are repeated on several
+// channels and days). Texts in the pool are reference counted and must not
+// be modified by their users.
+
+#define EVENTTEXTPOOLSIZE 4096 // initial number of hash buckets (grows as needed)
+
+class cEventTextPool {
+private:
+  struct tText {
+    tText *next;
+    unsigned int hash;
+    int refs;
+    char s[1]; // actually as long as the text
+    };
+  cMutex mutex;
+  tText **table;
+  int size;
+  int count;
+  size_t stored;
+  size_t referenced;
+  int references;
+  static unsigned int Hash(const char *s);
+  static tText *Text(const char *s) { return (tText *)(s - offsetof(tText, s)); }
+  void Grow(void);
+public:
+  cEventTextPool(void);
+  ~cEventTextPool();
+  char *Add(const char *s);
+       ///< Returns the pooled copy of s (or NULL if s is NULL).
+  void Del(const char *s);
+       ///< Releases s, which must have been returned by Add().
+  char *Unshare(char *s);
+       ///< Releases the pooled s and returns a private copy that may be modified.
+  char *Share(char *s);
+       ///< Frees the private s and returns its pooled copy.
+  cString Statistics(void);
+  };
+
+static cEventTextPool EventTextPool;
+
+cEventTextPool::cEventTextPool(void)
+{
+  size = EVENTTEXTPOOLSIZE;
+  table = MALLOC(tText *, size);
+  memset(table, 0, size * sizeof(tText *));
+  count = 0;
+  stored = 0;
+  referenced = 0;
+  references = 0;
+}
+
+cEventTextPool::~cEventTextPool()
+{
+  // Texts that are still referenced (by static objects that are destroyed
+  // later) are deliberately left alone, since the program ends anyway.
+  if (!count)
+     free(table);
+}
+
+unsigned int cEventTextPool::Hash(const char *s)
+{
+  unsigned int h = 2166136261U; // FNV-1a
+  while (*s)
+        h = (h ^ uchar(*s++)) * 16777619U;
+  return h;
+}
+
+void cEventTextPool::Grow(void)
+{
+  int NewSize = size * 2;
+  tText **NewTable = MALLOC(tText *, NewSize);
+  if (!NewTable)
+     return; // we can live with longer chains
+  memset(NewTable, 0, NewSize * sizeof(tText *));
+  for (int i = 0; i < size; i++) {
+      while (tText *t = table[i]) {
+            table[i] = t->next;
+            tText **p = &NewTable[t->hash & (NewSize - 1)];
+            t->next = *p;
+            *p = t;
+            }
+      }
+  free(table);
+  table = NewTable;
+  size = NewSize;
+}
+
+char *cEventTextPool::Add(const char *s)
+{
+  if (!s)
+     return NULL;
+  cMutexLock MutexLock(&mutex);
+  unsigned int h = Hash(s);
+  size_t l = strlen(s) + 1;
+  tText *t = table[h & (size - 1)];
+  while (t && (t->hash != h || strcmp(t->s, s) != 0))
+        t = t->next;
+  if (!t) {
+     if (count >= size)
+        Grow();
+     t = (tText *)malloc(offsetof(tText, s) + l);
+     if (!t) {
+        esyslog("ERROR: out of memory");
+        return NULL;
+        }
+     tText **p = &table[h & (size - 1)];
+     t->next = *p;
+     t->hash = h;
+     t->refs = 0;
+     memcpy(t->s, s, l);
+     *p = t;
+     count++;
+     stored += l;
+     }
+  t->refs++;
+  references++;
+  referenced += l;
+  return t->s;
+}
+
+void cEventTextPool::Del(const char *s)
+{
+  if (!s)
+     return;
+  cMutexLock MutexLock(&mutex);
+  tText *t = Text(s);
+  size_t l = strlen(s) + 1;
+  references--;
+  referenced -= l;
+  if (--t->refs == 0) {
+     tText **p = &table[t->hash & (size - 1)];
+     while (*p != t)
+           p = &(*p)->next;
+     *p = t->next;
+     count--;
+     stored -= l;
+     free(t);
+     }
+}
+
+char *cEventTextPool::Unshare(char *s)
+{
+  char *Copy = s ? strdup(s) : NULL;
+  Del(s);
+  return Copy;
+}
+
+char *cEventTextPool::Share(char *s)
+{
+  char *Pooled = Add(s);
+  free(s);
+  return Pooled;
+}
+
+cString cEventTextPool::Statistics(void)
+{
+  cMutexLock MutexLock(&mutex);
+  return cString::sprintf("%d texts in %zuKB, %d references to %zuKB, %d buckets", count, stored / KILOBYTE(1), references, referenced / KILOBYTE(1), size);
+}
+
+cString EpgMemoryStatistics(void)
+{
+  int Schedules = 0;
+  int Events = 0;
+  int Components = 0;
+  cSchedulesLock SchedulesLock;
+  if (const cSchedules *s = cSchedules::Schedules(SchedulesLock)) {
+     for (const cSchedule *Schedule = s->First(); Schedule; Schedule = s->Next(Schedule)) {
+         Schedules++;
+         for (const cEvent *Event = Schedule->Events()->First(); Event; Event = Schedule->Events()->Next(Event)) {
+             Events++;
+             if (Event->Components())
+                Components += Event->Components()->NumComponents();
+             }
+         }
+     }
+  return cString::sprintf("%d schedules, %d events (%zuKB), %d components, texts: %s", Schedules, Events, Events * sizeof(cEvent) / KILOBYTE(1), Components, *EventTextPool.Statistics());
+}
 
 // --- tComponent ------------------------------------------------------------
 
@@ -132,9 +315,9 @@ cEvent::cEvent(tEventID EventID)
 
 cEvent::~cEvent()
 {
-  free(title);
-  free(shortText);
-  free(description);
+  EventTextPool.Del(title);
+  EventTextPool.Del(shortText);
+  EventTextPool.Del(description);
   delete components;
 }
 
@@ -179,17 +362,23 @@ void cEvent::SetRunningStatus(int RunningStatus, cChannel *Channel)
 
 void cEvent::SetTitle(const char *Title)
 {
-  title = strcpyrealloc(title, Title);
+  char *Old = title;
+  title = EventTextPool.Add(Title);
+  EventTextPool.Del(Old);
 }
 
 void cEvent::SetShortText(const char *ShortText)
 {
-  shortText = strcpyrealloc(shortText, ShortText);
+  char *Old = shortText;
+  shortText = EventTextPool.Add(ShortText);
+  EventTextPool.Del(Old);
 }
 
 void cEvent::SetDescription(const char *Description)
 {
-  description = strcpyrealloc(description, Description);
+  char *Old = description;
+  description = EventTextPool.Add(Description);
+  EventTextPool.Del(Old);
 }
 
 void cEvent::SetComponents(cComponents *Components)
@@ -212,17 +401,23 @@ void cEvent::SetParentalRating(int ParentalRating)
 void cEvent::SetStartTime(time_t StartTime)
 {
   if (startTime != StartTime) {
-     if (schedule)
+     if (schedule) {
         schedule->UnhashEvent(this);
+        schedule->UnindexEvent(this);
+        }
      startTime = StartTime;
-     if (schedule)
+     if (schedule) {
+        schedule->IndexEvent(this);
         schedule->HashEvent(this);
+        }
      }
 }
 
 void cEvent::SetDuration(int Duration)
 {
   duration = Duration;
+  if (schedule && schedule->maxDuration < duration)
+     schedule->maxDuration = duration;
 }
 
 void cEvent::SetVps(time_t Vps)
@@ -438,9 +633,18 @@ void cEvent::Dump(FILE *f, const char *Prefix, bool InfoOnly) const
      if (!isempty(shortText))
         fprintf(f, "%sS %s\n", Prefix, shortText);
      if (!isempty(description)) {
-        strreplace(description, '\n', '|');
-        fprintf(f, "%sD %s\n", Prefix, description);
-        strreplace(description, '|', '\n');
+        // the description may be shared with other events, so it is not modified in place:
+        fprintf(f, "%sD ", Prefix);
+        for (const char *p = description; *p; ) {
+            size_t l = strcspn(p, "\n");
+            fwrite(p, 1, l, f);
+            p += l;
+            if (*p) {
+               fputc('|', f);
+               p++;
+               }
+            }
+        fputc('\n', f);
         }
      if (contents[0]) {
         fprintf(f, "%sG", Prefix);
@@ -663,6 +867,11 @@ static void StripControlCharacters(char *s)
 
 void cEvent::FixEpgBugs(void)
 {
+  // The texts are shared with other events, so the fixes work on private copies:
+  title = EventTextPool.Unshare(title);
+  shortText = EventTextPool.Unshare(shortText);
+  description = EventTextPool.Unshare(description);
+
   if (isempty(title)) {
      // we don't want any "(null)" titles
      title = strcpyrealloc(title, tr("No title"));
@@ -874,6 +1083,10 @@ Final:
   StripControlCharacters(title);
   StripControlCharacters(shortText);
   StripControlCharacters(description);
+
+  title = EventTextPool.Share(title);
+  shortText = EventTextPool.Share(shortText);
+  description = EventTextPool.Share(description);
 }
 
 // --- cSchedule -------------------------------------------------------------
@@ -884,12 +1097,14 @@ cSchedule::cSchedule(tChannelID ChannelID)
   hasRunning = false;
   modified = 0;
   presentSeen = 0;
+  maxDuration = 0;
 }
 
 cEvent *cSchedule::AddEvent(cEvent *Event)
 {
   events.Add(Event);
   Event->schedule = this;
+  IndexEvent(Event);
   HashEvent(Event);
   return Event;
 }
@@ -900,6 +1115,7 @@ void cSchedule::DelEvent(cEvent *Event)
      if (hasRunning && Event->IsRunning())
         ClrRunningStatus();
      UnhashEvent(Event);
+     UnindexEvent(Event);
      events.Del(Event);
      }
 }
@@ -918,34 +1134,63 @@ void cSchedule::UnhashEvent(cEvent *Event)
      eventsHashStartTime.Del(Event, Event->StartTime());
 }
 
+int cSchedule::FirstAfter(time_t Time) const
+{
+  // Returns the index of the first event in eventsByTime that starts after Time:
+  int lo = 0;
+  int hi = eventsByTime.Size();
+  while (lo < hi) {
+        int i = (lo + hi) / 2;
+        if (eventsByTime[i]->StartTime() <= Time)
+           lo = i + 1;
+        else
+           hi = i;
+        }
+  return lo;
+}
+
+int cSchedule::IndexOf(const cEvent *Event) const
+{
+  for (int i = FirstAfter(Event->StartTime()); i-- > 0 && eventsByTime[i]->StartTime() == Event->StartTime(); ) {
+      if (eventsByTime[i] == Event)
+         return i;
+      }
+  return -1;
+}
+
+void cSchedule::IndexEvent(cEvent *Event)
+{
+  if (maxDuration < Event->Duration())
+     maxDuration = Event->Duration();
+  eventsByTime.Insert(Event, FirstAfter(Event->StartTime()));
+}
+
+void cSchedule::UnindexEvent(cEvent *Event)
+{
+  int i = IndexOf(Event);
+  if (i >= 0)
+     eventsByTime.Remove(i);
+}
+
 const cEvent *cSchedule::GetPresentEvent(void) const
 {
-  const cEvent *pe = NULL;
   time_t now = time(NULL);
-  for (cEvent *p = events.First(); p; p = events.Next(p)) {
-      if (p->StartTime() <= now)
-         pe = p;
-      else if (p->StartTime() > now + 3600)
-         break;
+  // Only events that have already ended (and are removed by Cleanup() soon) or
+  // start within the next hour are checked for their running status:
+  for (int i = 0, n = FirstAfter(now + 3600); i < n; i++) {
+      const cEvent *p = eventsByTime[i];
       if (p->SeenWithin(RUNNINGSTATUSTIMEOUT) && p->RunningStatus() >= SI::RunningStatusPausing)
          return p;
       }
-  return pe;
+  int i = FirstAfter(now);
+  return i > 0 ? eventsByTime[i - 1] : NULL;
 }
 
 const cEvent *cSchedule::GetFollowingEvent(void) const
 {
   const cEvent *p = GetPresentEvent();
-  if (p)
-     p = events.Next(p);
-  else {
-     time_t now = time(NULL);
-     for (p = events.First(); p; p = events.Next(p)) {
-         if (p->StartTime() >= now)
-            break;
-         }
-     }
-  return p;
+  int i = p ? IndexOf(p) + 1 : FirstAfter(time(NULL) - 1);
+  return i < eventsByTime.Size() ? eventsByTime[i] : NULL;
 }
 
 const cEvent *cSchedule::GetEvent(tEventID EventID, time_t StartTime) const
@@ -960,16 +1205,16 @@ const cEvent *cSchedule::GetEvent(tEventID EventID, time_t StartTime) const
 
 const cEvent *cSchedule::GetEventAround(time_t Time) const
 {
-  const cEvent *pe = NULL;
-  time_t delta = INT_MAX;
-  for (cEvent *p = events.First(); p; p = events.Next(p)) {
-      time_t dt = Time - p->StartTime();
-      if (dt >= 0 && dt < delta && p->EndTime() >= Time) {
-         delta = dt;
-         pe = p;
+  // The latest event that has started at Time and is still running then:
+  for (int i = FirstAfter(Time); i-- > 0; ) {
+      const cEvent *p = eventsByTime[i];
+      if (p->EndTime() >= Time) {
+         while (i-- > 0 && eventsByTime[i]->StartTime() == p->StartTime() && eventsByTime[i]->EndTime() >= Time)
+               p = eventsByTime[i]; // same as the linear search, which found the first one of several with the same start time
+         return p;
          }
       }
-  return pe;
+  return NULL;
 }
 
 void cSchedule::SetRunningStatus(cEvent *Event, int RunningStatus, cChannel *Channel)
@@ -1010,7 +1255,17 @@ void cSchedule::ResetVersions(void)
 
 void cSchedule::Sort(void)
 {
-  events.Sort();
+  // Brings the list into the order of eventsByTime, touching only the events that are out of place:
+  cEvent *p = events.First();
+  for (int i = 0; i < eventsByTime.Size(); i++) {
+      cEvent *e = eventsByTime[i];
+      if (e == p)
+         p = events.Next(p);
+      else {
+         events.Del(e, false);
+         events.Ins(e, p);
+         }
+      }
   // Make sure there are no RunningStatusUndefined before the currently running event:
   if (hasRunning) {
      for (cEvent *p = events.First(); p; p = events.Next(p)) {
@@ -1024,30 +1279,58 @@ void cSchedule::Sort(void)
 void cSchedule::DropOutdated(time_t SegmentStart, time_t SegmentEnd, uchar TableID, uchar Version)
 {
   if (SegmentStart > 0 && SegmentEnd > 0) {
-     for (cEvent *p = events.First(); p; p = events.Next(p)) {
+     cVector<cEvent *> Outdated;
+     // Events that start more than maxDuration before the segment can't overlap with it:
+     for (int i = FirstAfter(SegmentStart - maxDuration); i < eventsByTime.Size(); i++) {
+         cEvent *p = eventsByTime[i];
          if (p->EndTime() > SegmentStart) {
             if (p->StartTime() < SegmentEnd) {
                // The event overlaps with the given time segment.
                if (p->TableID() > TableID || p->TableID() == TableID && p->Version() != Version) {
                   // The segment overwrites all events from tables with higher ids, and
                   // within the same table id all events must have the same version.
-                  // We can't delete the event right here because a timer might have
-                  // a pointer to it, so let's set its id and start time to 0 to have it
-                  // "phased out":
-                  if (hasRunning && p->IsRunning())
-                     ClrRunningStatus();
-                  UnhashEvent(p);
-                  p->eventID = 0;
-                  p->startTime = 0;
+                  Outdated.Append(p);
                   }
                }
             else
                break;
             }
          }
+     for (int i = 0; i < Outdated.Size(); i++) {
+         // We can't delete the event right here because a timer might have
+         // a pointer to it, so let's set its id and start time to 0 to have it
+         // "phased out":
+         cEvent *p = Outdated[i];
+         if (hasRunning && p->IsRunning())
+            ClrRunningStatus();
+         UnhashEvent(p);
+         UnindexEvent(p);
+         p->eventID = 0;
+         p->startTime = 0;
+         IndexEvent(p);
+         }
      }
 }
 
+void cSchedule::PhaseOut(void)
+{
+  // Like in DropOutdated() the events can't be deleted right here, because a
+  // timer might have a pointer to them:
+  for (cEvent *p = events.First(); p; p = events.Next(p)) {
+      if (p->EventID() || p->StartTime()) {
+         if (hasRunning && p->IsRunning())
+            ClrRunningStatus();
+         UnhashEvent(p);
+         p->eventID = 0;
+         p->startTime = 0;
+         }
+      }
+  // Now all events have the same start time, so the list order is a valid time order:
+  eventsByTime.Clear();
+  for (cEvent *p = events.First(); p; p = events.Next(p))
+      eventsByTime.Append(p);
+}
+
 void cSchedule::Cleanup(void)
 {
   Cleanup(time(NULL));
@@ -1055,8 +1338,8 @@ void cSchedule::Cleanup(void)
 
 void cSchedule::Cleanup(time_t Time)
 {
-  cEvent *Event;
-  while ((Event = events.First()) != NULL) {
+  while (eventsByTime.Size()) {
+        cEvent *Event = eventsByTime[0];
         if (!Event->HasTimer() && Event->EndTime() + Setup.EPGLinger * 60 + 3600 < Time) // adding one hour for safety
            DelEvent(Event);
         else
@@ -1097,9 +1380,10 @@ void cSchedule::Dump(FILE *f, const char *Prefix, eDumpMode DumpMode, time_t AtT
      }
 }
 
-bool cSchedule::Read(FILE *f, cSchedules *Schedules)
+bool cSchedule::Read(FILE *f, cSchedules *Schedules, bool Supersede)
 {
   if (Schedules) {
+     cVector<cSchedule *> Segments;
      cReadLine ReadLine;
      char *s;
      while ((s = ReadLine.Read(f)) != NULL) {
@@ -1113,8 +1397,26 @@ bool cSchedule::Read(FILE *f, cSchedules *Schedules)
                  if (channelID.Valid()) {
                     cSchedule *p = Schedules->AddSchedule(channelID);
                     if (p) {
-                       if (!cEvent::Read(f, p))
+                       if (Supersede) {
+                          int i = 0;
+                          while (i < Segments.Size() && Segments[i] != p)
+                                i++;
+                          if (i < Segments.Size())
+                             p->PhaseOut(); // this is a newer segment from an incremental dump
+                          else
+                             Segments.Append(p);
+                          }
+                       if (!cEvent::Read(f, p)) {
+                          if (Supersede && feof(f)) {
+                             // The last incremental dump has been cut off (by a crash or a full disk),
+                             // so let's keep what has been read so far instead of dropping everything:
+                             esyslog("ERROR: incomplete EPG data of %s at end of file - ignored", *channelID.ToString());
+                             p->Sort();
+                             Schedules->SetModified(p);
+                             return true;
+                             }
                           return false;
+                          }
                        p->Sort();
                        Schedules->SetModified(p);
                        }
@@ -1140,16 +1442,22 @@ bool cSchedule::Read(FILE *f, cSchedules *Schedules)
 class cEpgDataWriter : public cThread {
 private:
   cMutex mutex;
+  time_t lastWrite;
+  off_t fullSize;
 protected:
   virtual void Action(void);
 public:
   cEpgDataWriter(void);
   void Perform(void);
+  void Compact(void) { lastWrite = 0; }
+       ///< Makes the next call to Perform() write the complete EPG data file.
   };
 
 cEpgDataWriter::cEpgDataWriter(void)
 :cThread("epg data writer", true)
 {
+  lastWrite = 0;
+  fullSize = 0;
 }
 
 void cEpgDataWriter::Action(void)
@@ -1160,16 +1468,26 @@ void cEpgDataWriter::Action(void)
 void cEpgDataWriter::Perform(void)
 {
   cMutexLock MutexLock(&mutex); // to make sure fore- and background calls don't cause parellel dumps!
+  time_t now = time(NULL);
   {
     cSchedulesLock SchedulesLock(true, 1000);
     cSchedules *s = (cSchedules *)cSchedules::Schedules(SchedulesLock);
     if (s) {
-       time_t now = time(NULL);
        for (cSchedule *p = s->First(); p; p = s->Next(p))
            p->Cleanup(now);
        }
   }
-  cSchedules::Dump();
+  off_t Size = (Setup.EPGIncrementalWrite && lastWrite) ? FileSize(cSchedules::epgDataFileName) : -1;
+  if (Size > 0 && Size <= fullSize * EPGDATACOMPACTRATIO) {
+     // Events that have been deleted by Cleanup() are only removed from the
+     // file when it is compacted, but they are outdated anyway:
+     if (cSchedules::DumpModified(lastWrite))
+        lastWrite = now;
+     }
+  else if (cSchedules::Dump()) {
+     lastWrite = now;
+     fullSize = max(FileSize(cSchedules::epgDataFileName), off_t(1));
+     }
 }
 
 static cEpgDataWriter EpgDataWriter;
@@ -1246,6 +1564,7 @@ bool cSchedules::ClearAll(void)
          Timer->SetEvent(NULL);
      for (cSchedule *Schedule = s->First(); Schedule; Schedule = s->Next(Schedule))
          Schedule->Cleanup(INT_MAX);
+     EpgDataWriter.Compact();
      return true;
      }
   return false;
@@ -1278,6 +1597,40 @@ bool cSchedules::Dump(FILE *f, const char *Prefix, eDumpMode DumpMode, time_t At
   return false;
 }
 
+bool cSchedules::DumpModified(time_t Since)
+{
+  cSchedulesLock SchedulesLock;
+  cSchedules *s = (cSchedules *)Schedules(SchedulesLock);
+  if (s && epgDataFileName) {
+     FILE *f = fopen(epgDataFileName, "a");
+     if (!f) {
+        LOG_ERROR_STR(epgDataFileName);
+        return false;
+        }
+     off_t Size = fseeko(f, 0, SEEK_END) == 0 ? ftello(f) : -1;
+     int n = 0;
+     for (cSchedule *p = s->First(); p; p = s->Next(p)) {
+         // Schedules modified within the same second as the last dump are written again, to be on the safe side:
+         if (p->Modified() >= Since) {
+            p->Dump(f);
+            n++;
+            }
+         }
+     bool result = !ferror(f);
+     if (fclose(f) < 0 || !result) {
+        LOG_ERROR_STR(epgDataFileName);
+        // Don't leave an incomplete segment at the end of the file (cSchedule::Read() could cope with it, though):
+        if (Size >= 0 && truncate(epgDataFileName, Size) < 0)
+           LOG_ERROR_STR(epgDataFileName);
+        return false;
+        }
+     if (n)
+        dsyslog("appended %d modified schedule%s to %s", n, n != 1 ? "s" : "", epgDataFileName);
+     return true;
+     }
+  return false;
+}
+
 bool cSchedules::Read(FILE *f)
 {
   cSchedulesLock SchedulesLock(true, 1000);
@@ -1295,7 +1648,7 @@ bool cSchedules::Read(FILE *f)
         else
            return false;
         }
-     bool result = cSchedule::Read(f, s);
+     bool result = cSchedule::Read(f, s, OwnFile);
      if (OwnFile)
         fclose(f);
      if (result) {
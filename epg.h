@@ -78,7 +78,7 @@ private:
   uchar version;           // Version number of section this event came from
   uchar runningStatus;     // 0=undefined, 1=not running, 2=starts in a few seconds, 3=pausing, 4=running
   uchar parentalRating;    // Parental rating of this event
-  char *title;             // Title of this event
+  char *title;             // Title of this event (texts are pooled, see cEventTextPool)
   char *shortText;         // Short description of this event (typically the episode name in case of a series)
   char *description;       // Description of this event
   cComponents *components; // The stream components of this event
@@ -141,14 +141,22 @@ public:
 class cSchedules;
 
 class cSchedule : public cListObject  {
+  friend class cEvent;
 private:
   tChannelID channelID;
   cList<cEvent> events;
-  cHash<cEvent> eventsHashID;
-  cHash<cEvent> eventsHashStartTime;
+  cVector<cEvent *> eventsByTime; // all events, sorted by start time (events may be unsorted until Sort() is called)
+  cOpenHash<cEvent> eventsHashID;
+  cOpenHash<cEvent> eventsHashStartTime;
   bool hasRunning;
   time_t modified;
   time_t presentSeen;
+  int maxDuration; // the longest duration of any event ever indexed in this schedule
+  int FirstAfter(time_t Time) const;
+  int IndexOf(const cEvent *Event) const;
+  void IndexEvent(cEvent *Event);
+  void UnindexEvent(cEvent *Event);
+  void PhaseOut(void);
 public:
   cSchedule(tChannelID ChannelID);
   tChannelID ChannelID(void) const { return channelID; }
@@ -174,7 +182,12 @@ public:
   const cEvent *GetEvent(tEventID EventID, time_t StartTime = 0) const;
   const cEvent *GetEventAround(time_t Time) const;
   void Dump(FILE *f, const char *Prefix = "", eDumpMode DumpMode = dmAll, time_t AtTime = 0) const;
-  static bool Read(FILE *f, cSchedules *Schedules);
+  static bool Read(FILE *f, cSchedules *Schedules, bool Supersede = false);
+       ///< Reads the schedules contained in f and adds their events to Schedules.
+       ///< If Supersede is true, a schedule that occurs more than once in f
+       ///< (as is the case after incremental dumps, see cSchedules::DumpModified())
+       ///< only keeps the events of its last occurrence. If the data of the last
+       ///< schedule in f has been cut off, the events read so far are kept.
   };
 
 class cSchedulesLock {
@@ -189,6 +202,7 @@ public:
 class cSchedules : public cList<cSchedule> {
   friend class cSchedule;
   friend class cSchedulesLock;
+  friend class cEpgDataWriter;
 private:
   cRwLock rwlock;
   static cSchedules schedules;
@@ -207,6 +221,10 @@ public:
   static void ResetVersions(void);
   static bool ClearAll(void);
   static bool Dump(FILE *f = NULL, const char *Prefix = "", eDumpMode DumpMode = dmAll, time_t AtTime = 0);
+  static bool DumpModified(time_t Since);
+         ///< Appends all schedules that have been modified since the given time
+         ///< to the EPG data file. Reading that file later will let these
+         ///< segments replace the earlier ones of the same channels.
   static bool Read(FILE *f = NULL);
   cSchedule *AddSchedule(tChannelID ChannelID);
   const cSchedule *GetSchedule(tChannelID ChannelID) const;
@@ -221,6 +239,10 @@ public:
 
 void ReportEpgBugFixStats(bool Force = false);
 
+cString EpgMemoryStatistics(void);
+     ///< Returns a summary of the memory used by the EPG data. The texts of
+     ///< all events are pooled, so that identical texts are stored only once.
+
 class cEpgHandler : public cListObject {
 public:
   cEpgHandler(void);
@@ -70,13 +70,17 @@ bool cFilterData::Matches(u_short Pid, u_char Tid)
 cFilter::cFilter(void)
 {
   sectionHandler = NULL;
+  queue = NULL;
   on = false;
+  queued = false;
 }
 
 cFilter::cFilter(u_short Pid, u_char Tid, u_char Mask)
 {
   sectionHandler = NULL;
+  queue = NULL;
   on = false;
+  queued = false;
   Set(Pid, Tid, Mask);
 }
 
@@ -123,6 +127,14 @@ void cFilter::SetStatus(bool On)
      }
 }
 
+void cFilter::SetQueued(bool On)
+{
+  if (!sectionHandler)
+     queued = On;
+  else
+     esyslog("ERROR: can't change the queued mode of an attached filter");
+}
+
 bool cFilter::Matches(u_short Pid, u_char Tid)
 {
   if (on) {
@@ -37,13 +37,16 @@ public:
 
 class cChannel;
 class cSectionHandler;
+class cSectionQueue;
 
 class cFilter : public cListObject {
   friend class cSectionHandler;
 private:
   cSectionHandler *sectionHandler;
+  cSectionQueue *queue;
   cList<cFilterData> data;
   bool on;
+  bool queued;
 protected:
   cFilter(void);
   cFilter(u_short Pid, u_char Tid, u_char Mask = 0xFF);
@@ -66,6 +69,20 @@ protected:
        ///< its Process() function called at any given time. It is allowed
        ///< that more than one cFilter are set up to receive the same Pid/Tid.
        ///< The Process() function must return as soon as possible.
+       ///< If this filter has been set to queued mode (see SetQueued()), the
+       ///< above guarantee only holds for the calls to this filter's Process()
+       ///< function.
+  void SetQueued(bool On);
+       ///< If On is true, the sections for this filter are queued and then
+       ///< handed to Process() by one of the section handler's worker threads,
+       ///< so that a Process() function that takes long (for instance because
+       ///< it has to wait for a lock) doesn't delay the other filters of the same
+       ///< device. The sections are still delivered in the order they have been
+       ///< received, and only one call to this filter's Process() function is
+       ///< active at any given time. However, it may be called while other filters
+       ///< of the same section handler are processing data, so it must not access
+       ///< their data without proper locking.
+       ///< Must be called before the filter is attached to a device.
   int Source(void);
        ///< Returns the source of the data delivered to this filter.
   int Transponder(void);
@@ -27,12 +27,12 @@ const char *DefaultFontFix = "Courier:Bold";
 
 // --- cFreetypeFont ---------------------------------------------------------
 
-#define KERNING_UNKNOWN  (-10000)
-
-struct tKerning {
+class cKerningPair : public cListObject {
+public:
   uint prevSym;
+  uint sym;
   int kerning;
-  tKerning(uint PrevSym, int Kerning = 0) { prevSym = PrevSym; kerning = Kerning; }
+  cKerningPair(uint PrevSym, uint Sym, int Kerning) { prevSym = PrevSym; sym = Sym; kerning = Kerning; }
   };
 
 class cGlyph : public cListObject {
@@ -46,7 +46,6 @@ private:
   int width; ///< The number of pixels per bitmap row.
   int rows;  ///< The number of bitmap rows.
   int pitch; ///< The pitch's absolute value is the number of bytes taken by one bitmap row, including padding.
-  cVector<tKerning> kerningCache;
 public:
   cGlyph(uint CharCode, FT_GlyphSlotRec_ *GlyphData);
   virtual ~cGlyph();
@@ -59,8 +58,6 @@ public:
   int Width(void) const { return width; }
   int Rows(void) const { return rows; }
   int Pitch(void) const { return pitch; }
-  int GetKerningCache(uint PrevSym) const;
-  void SetKerningCache(uint PrevSym, int Kerning);
   };
 
 cGlyph::cGlyph(uint CharCode, FT_GlyphSlotRec_ *GlyphData)
@@ -82,33 +79,33 @@ cGlyph::~cGlyph()
   free(bitmap);
 }
 
-int cGlyph::GetKerningCache(uint PrevSym) const
-{
-  for (int i = kerningCache.Size(); --i > 0; ) {
-      if (kerningCache[i].prevSym == PrevSym)
-         return kerningCache[i].kerning;
-      }
-  return KERNING_UNKNOWN;
-}
-
-void cGlyph::SetKerningCache(uint PrevSym, int Kerning)
-{
-  kerningCache.Append(tKerning(PrevSym, Kerning));
-}
-
 class cFreetypeFont : public cFont {
 private:
   cString fontName;
   int size;
+  int charWidth;
   int height;
   int bottom;
   FT_Library library; ///< Handle to library
   FT_Face face; ///< Handle to face object
   mutable cList<cGlyph> glyphCacheMonochrome;
   mutable cList<cGlyph> glyphCacheAntiAliased;
+  mutable cGlyph *glyphsLatin1[2][256]; ///< Direct access to the cached glyphs of the first 256 characters (monochrome/anti-aliased).
+  mutable cOpenHash<cGlyph> glyphsHash[2]; ///< Access to the cached glyphs of all other characters (monochrome/anti-aliased).
+  mutable cList<cKerningPair> kerningCache;
+  mutable cOpenHash<cKerningPair> kerningHash;
+  bool hasKerning;
   int Bottom(void) const { return bottom; }
   int Kerning(cGlyph *Glyph, uint PrevSym) const;
   cGlyph* Glyph(uint CharCode, bool AntiAliased = false) const;
+  cBitmap *RenderText(const char *s, tColor ColorFg, tColor ColorBg, int Limit, bool AntiAliased, int &Left, int &Top) const;
+       ///< Renders the given text into a new bitmap, the index of each pixel being
+       ///< the blend level (or 1 in monochrome mode) and the palette holding the
+       ///< resulting colors. Index 0 marks pixels that are not drawn. Glyphs that
+       ///< would extend beyond Limit (relative to the beginning of the text) are
+       ///< left out. Left and Top receive the offset of the bitmap relative to
+       ///< the position where the text is drawn. Returns NULL if there are no
+       ///< pixels to draw, or if the bitmap would be too large.
 public:
   cFreetypeFont(const char *Name, int CharHeight, int CharWidth = 0);
   virtual ~cFreetypeFont();
@@ -117,6 +114,7 @@ public:
   virtual int Width(uint c) const;
   virtual int Width(const char *s) const;
   virtual int Height(void) const { return height; }
+  int CharWidth(void) const { return charWidth; }
   virtual void DrawText(cBitmap *Bitmap, int x, int y, const char *s, tColor ColorFg, tColor ColorBg, int Width) const;
   virtual void DrawText(cPixmap *Pixmap, int x, int y, const char *s, tColor ColorFg, tColor ColorBg, int Width) const;
   };
@@ -125,12 +123,16 @@ cFreetypeFont::cFreetypeFont(const char *Name, int CharHeight, int CharWidth)
 {
   fontName = Name;
   size = CharHeight;
+  charWidth = CharWidth;
   height = 0;
   bottom = 0;
+  hasKerning = false;
+  memset(glyphsLatin1, 0, sizeof(glyphsLatin1));
   int error = FT_Init_FreeType(&library);
   if (!error) {
      error = FT_New_Face(library, Name, 0, &face);
      if (!error) {
+        hasKerning = FT_HAS_KERNING(face);
         if (face->num_fixed_sizes && face->available_sizes) { // fixed font
            // TODO what exactly does all this mean?
            height = face->available_sizes->height;
@@ -180,16 +182,22 @@ cFreetypeFont::~cFreetypeFont()
 int cFreetypeFont::Kerning(cGlyph *Glyph, uint PrevSym) const
 {
   int kerning = 0;
-  if (Glyph && PrevSym) {
-     kerning = Glyph->GetKerningCache(PrevSym);
-     if (kerning == KERNING_UNKNOWN) {
-        FT_Vector delta;
-        FT_UInt glyph_index = FT_Get_Char_Index(face, Glyph->CharCode());
-        FT_UInt glyph_index_prev = FT_Get_Char_Index(face, PrevSym);
-        FT_Get_Kerning(face, glyph_index_prev, glyph_index, FT_KERNING_DEFAULT, &delta);
-        kerning = delta.x / 64;
-        Glyph->SetKerningCache(PrevSym, kerning);
-        }
+  if (Glyph && PrevSym && hasKerning) {
+     uint Sym = Glyph->CharCode();
+     uint Key = PrevSym * 0x10001 + Sym;
+     int Slot;
+     for (cKerningPair *k = kerningHash.First(Key, Slot); k; k = kerningHash.Next(Key, Slot)) {
+         if (k->prevSym == PrevSym && k->sym == Sym)
+            return k->kerning;
+         }
+     FT_Vector delta;
+     FT_UInt glyph_index = FT_Get_Char_Index(face, Sym);
+     FT_UInt glyph_index_prev = FT_Get_Char_Index(face, PrevSym);
+     FT_Get_Kerning(face, glyph_index_prev, glyph_index, FT_KERNING_DEFAULT, &delta);
+     kerning = delta.x / 64;
+     cKerningPair *k = new cKerningPair(PrevSym, Sym, kerning);
+     kerningCache.Add(k);
+     kerningHash.Add(k, Key);
      }
   return kerning;
 }
@@ -202,10 +210,14 @@ cGlyph* cFreetypeFont::Glyph(uint CharCode, bool AntiAliased) const
 
   // Lookup in cache:
   cList<cGlyph> *glyphCache = AntiAliased ? &glyphCacheAntiAliased : &glyphCacheMonochrome;
-  for (cGlyph *g = glyphCache->First(); g; g = glyphCache->Next(g)) {
-      if (g->CharCode() == CharCode)
-         return g;
-      }
+  cGlyph **glyphLatin1 = CharCode < 256 ? &glyphsLatin1[AntiAliased][CharCode] : NULL;
+  cOpenHash<cGlyph> *glyphHash = &glyphsHash[AntiAliased];
+  if (glyphLatin1) {
+     if (*glyphLatin1)
+        return *glyphLatin1;
+     }
+  else if (cGlyph *g = glyphHash->Get(CharCode))
+     return g;
 
   FT_UInt glyph_index = FT_Get_Char_Index(face, CharCode);
 
@@ -227,12 +239,25 @@ cGlyph* cFreetypeFont::Glyph(uint CharCode, bool AntiAliased) const
      else { //new bitmap
         cGlyph *Glyph = new cGlyph(CharCode, face->glyph);
         glyphCache->Add(Glyph);
+        if (glyphLatin1)
+           *glyphLatin1 = Glyph;
+        else
+           glyphHash->Add(Glyph, CharCode);
         return Glyph;
         }
      }
 #define UNKNOWN_GLYPH_INDICATOR '?'
-  if (CharCode != UNKNOWN_GLYPH_INDICATOR)
-     return Glyph(UNKNOWN_GLYPH_INDICATOR, AntiAliased);
+  if (CharCode != UNKNOWN_GLYPH_INDICATOR) {
+     // Remember the indicator for this character, so that FreeType isn't asked again:
+     cGlyph *Glyph = cFreetypeFont::Glyph(UNKNOWN_GLYPH_INDICATOR, AntiAliased);
+     if (Glyph) {
+        if (glyphLatin1)
+           *glyphLatin1 = Glyph;
+        else
+           glyphHash->Add(Glyph, CharCode);
+        }
+     return Glyph;
+     }
   return NULL;
 }
 
@@ -264,6 +289,115 @@ int cFreetypeFont::Width(const char *s) const
   return w;
 }
 
+// The text run cache keeps the most recently drawn texts as ready-made bitmaps, so that a text
+// that is drawn again with the same font, colors and width (as happens with
+// menu items and EPG lines every time the OSD is redrawn) is simply copied
+// into the pixmap instead of being blended glyph by glyph. The cache is shared
+// by all fonts, so skins and plugins that use the same font and size also
+// share their text runs.
+
+#define TEXTRUNCACHESIZE (4 * 1024 * 1024) // maximum number of bytes in all cached text runs
+#define TEXTRUNMAXSIZE   (TEXTRUNCACHESIZE / 16) // larger text runs are not cached
+
+class cTextRun : public cListObject {
+public:
+  cString fontName;
+  int size;
+  int charWidth;
+  cString text;
+  tColor colorFg;
+  tColor colorBg;
+  int limit;
+  bool antiAliased;
+  uint key;
+  int left;
+  int top;
+  cBitmap *bitmap;
+  cTextRun(const cFreetypeFont *Font, const char *s, tColor ColorFg, tColor ColorBg, int Limit, bool AntiAliased, uint Key, int Left, int Top, cBitmap *Bitmap);
+  virtual ~cTextRun() { delete bitmap; }
+  bool Matches(const cFreetypeFont *Font, const char *s, tColor ColorFg, tColor ColorBg, int Limit, bool AntiAliased) const;
+  int Bytes(void) const { return bitmap->Width() * bitmap->Height() + sizeof(*this); }
+  };
+
+cTextRun::cTextRun(const cFreetypeFont *Font, const char *s, tColor ColorFg, tColor ColorBg, int Limit, bool AntiAliased, uint Key, int Left, int Top, cBitmap *Bitmap)
+{
+  fontName = Font->FontName();
+  size = Font->Size();
+  charWidth = Font->CharWidth();
+  text = s;
+  colorFg = ColorFg;
+  colorBg = ColorBg;
+  limit = Limit;
+  antiAliased = AntiAliased;
+  key = Key;
+  left = Left;
+  top = Top;
+  bitmap = Bitmap;
+}
+
+bool cTextRun::Matches(const cFreetypeFont *Font, const char *s, tColor ColorFg, tColor ColorBg, int Limit, bool AntiAliased) const
+{
+  return colorFg == ColorFg && colorBg == ColorBg && limit == Limit && antiAliased == AntiAliased
+      && size == Font->Size() && charWidth == Font->CharWidth()
+      && strcmp(text, s) == 0 && strcmp(fontName, Font->FontName()) == 0;
+}
+
+// The text run cache must only be accessed while holding the pixmap lock
+// (see LOCK_PIXMAPS), which is the lock any text drawing into a pixmap
+// needs anyway.
+
+class cTextRunCache {
+private:
+  cList<cTextRun> textRuns; ///< The most recently used text run comes first.
+  cOpenHash<cTextRun> textRunsHash;
+  int bytes;
+public:
+  cTextRunCache(void) { bytes = 0; }
+  static uint Key(const cFreetypeFont *Font, const char *s, tColor ColorFg, tColor ColorBg, int Limit);
+  cTextRun *Get(const cFreetypeFont *Font, const char *s, tColor ColorFg, tColor ColorBg, int Limit, bool AntiAliased, uint Key);
+  void Add(cTextRun *TextRun);
+  };
+
+static cTextRunCache TextRunCache;
+
+uint cTextRunCache::Key(const cFreetypeFont *Font, const char *s, tColor ColorFg, tColor ColorBg, int Limit)
+{
+  uint Key = 2166136261U; // FNV-1a
+  while (*s)
+        Key = (Key ^ uchar(*s++)) * 16777619U;
+  return Key ^ (ColorFg * 31) ^ ColorBg ^ (uint(Limit) << 16) ^ Font->Size();
+}
+
+cTextRun *cTextRunCache::Get(const cFreetypeFont *Font, const char *s, tColor ColorFg, tColor ColorBg, int Limit, bool AntiAliased, uint Key)
+{
+  int Slot;
+  for (cTextRun *t = textRunsHash.First(Key, Slot); t; t = textRunsHash.Next(Key, Slot)) {
+      if (t->Matches(Font, s, ColorFg, ColorBg, Limit, AntiAliased)) {
+         if (t != textRuns.First()) {
+            textRuns.Del(t, false);
+            textRuns.Ins(t);
+            }
+         return t;
+         }
+      }
+  return NULL;
+}
+
+void cTextRunCache::Add(cTextRun *TextRun)
+{
+  bytes += TextRun->Bytes();
+  while (bytes > TEXTRUNCACHESIZE) {
+        cTextRun *t = textRuns.Last();
+        if (!t)
+           break;
+        bytes -= t->Bytes();
+        textRunsHash.Del(t, t->key);
+        textRuns.Del(t);
+        }
+  textRuns.Ins(TextRun);
+  textRunsHash.Add(TextRun, TextRun->key);
+}
+
 #define MAX_BLEND_LEVELS 256
 
 void cFreetypeFont::DrawText(cBitmap *Bitmap, int x, int y, const char *s, tColor ColorFg, tColor ColorBg, int Width) const
@@ -338,6 +472,25 @@ void cFreetypeFont::DrawText(cPixmap *Pixmap, int x, int y, const char *s, tColo
      s = bs;
 #endif
      bool AntiAliased = Setup.AntiAlias;
+     if (Pixmap->Layer() != 0 || IS_OPAQUE(ColorFg) && (IS_OPAQUE(ColorBg) || !AntiAliased)) {
+        // The pixels don't need to be blended with the pixmap's contents, so
+        // a cached text run can simply be copied into it:
+        LOCK_PIXMAPS;
+        int Limit = Width ? Width - x : INT_MAX;
+        uint Key = cTextRunCache::Key(this, s, ColorFg, ColorBg, Limit);
+        cTextRun *TextRun = TextRunCache.Get(this, s, ColorFg, ColorBg, Limit, AntiAliased, Key);
+        if (!TextRun) {
+           int Left, Top;
+           if (cBitmap *Bitmap = RenderText(s, ColorFg, ColorBg, Limit, AntiAliased, Left, Top)) {
+              TextRun = new cTextRun(this, s, ColorFg, ColorBg, Limit, AntiAliased, Key, Left, Top, Bitmap);
+              TextRunCache.Add(TextRun);
+              }
+           }
+        if (TextRun) {
+           Pixmap->DrawBitmap(cPoint(x + TextRun->left, y + TextRun->top), *TextRun->bitmap, 0, 0, true);
+           return;
+           }
+        }
      uint prevSym = 0;
      while (*s) {
            int sl = Utf8CharLen(s);
@@ -377,6 +530,76 @@ void cFreetypeFont::DrawText(cPixmap *Pixmap, int x, int y, const char *s, tColo
      }
 }
 
+cBitmap *cFreetypeFont::RenderText(const char *s, tColor ColorFg, tColor ColorBg, int Limit, bool AntiAliased, int &Left, int &Top) const
+{
+  // The first pass determines the bounding box of all pixels, the second
+  // one draws them:
+  int x1 = INT_MAX, y1 = INT_MAX, x2 = INT_MIN, y2 = INT_MIN;
+  cBitmap *Bitmap = NULL;
+  for (int Pass = 0; Pass < 2; Pass++) {
+      const char *p = s;
+      int x = 0;
+      uint prevSym = 0;
+      while (*p) {
+            int sl = Utf8CharLen(p);
+            uint sym = Utf8CharGet(p, sl);
+            p += sl;
+            cGlyph *g = Glyph(sym, AntiAliased);
+            if (!g)
+               continue;
+            int kerning = Kerning(g, prevSym);
+            prevSym = sym;
+            uchar *buffer = g->Bitmap();
+            int symWidth = g->Width();
+            if (x + symWidth + g->Left() + kerning - 1 > Limit)
+               break; // we don't draw partial characters
+            int gx = x + g->Left() + kerning;
+            int gy = height - Bottom() - g->Top();
+            if (!Bitmap) {
+               if (g->Rows() > 0 && g->Pitch() > 0) {
+                  x1 = min(x1, gx);
+                  x2 = max(x2, gx + (AntiAliased ? g->Pitch() - 1 : min(g->Pitch() * 8 - 1, symWidth)));
+                  y1 = min(y1, gy);
+                  y2 = max(y2, gy + g->Rows() - 1);
+                  }
+               }
+            else {
+               for (int row = 0; row < g->Rows(); row++) {
+                   for (int pitch = 0; pitch < g->Pitch(); pitch++) {
+                       uchar bt = *(buffer + (row * g->Pitch() + pitch));
+                       if (AntiAliased) {
+                          if (bt > 0x00)
+                             Bitmap->SetIndex(gx + pitch - x1, gy + row - y1, bt);
+                          }
+                       else { //monochrome rendering
+                          for (int col = 0; col < 8 && col + pitch * 8 <= symWidth; col++) {
+                              if (bt & 0x80)
+                                 Bitmap->SetIndex(gx + col + pitch * 8 - x1, gy + row - y1, 1);
+                              bt <<= 1;
+                              }
+                          }
+                       }
+                   }
+               }
+            x += g->AdvanceX() + kerning;
+            }
+      if (!Bitmap) {
+         if (x1 > x2 || y1 > y2 || (x2 - x1 + 1) * (y2 - y1 + 1) > TEXTRUNMAXSIZE)
+            return NULL;
+         Bitmap = new cBitmap(x2 - x1 + 1, y2 - y1 + 1, 8);
+         if (AntiAliased) {
+            for (int i = 1; i < MAX_BLEND_LEVELS; i++)
+                Bitmap->SetColor(i, AlphaBlend(ColorFg, ColorBg, i));
+            }
+         else
+            Bitmap->SetColor(1, ColorFg);
+         }
+      }
+  Left = x1;
+  Top = y1;
+  return Bitmap;
+}
+
 // --- cDummyFont ------------------------------------------------------------
 
 // A dummy font, in case there are no fonts installed:
@@ -536,6 +759,47 @@ cString cFont::Bidi(const char *Ltr)
 
 // --- cTextWrapper ----------------------------------------------------------
 
+// The same texts (EPG descriptions, recording info etc.) are typically wrapped
+// again each time they are displayed, so the most recently wrapped texts are
+// kept together with their line breaks.
+
+#define TEXTWRAPPERCACHESIZE 16 // number of wrapped texts to keep
+
+class cWrappedText : public cListObject {
+public:
+  const cFont *font;
+  cString fontName;
+  int size;
+  int width;
+  bool antiAliased;
+  cString text;
+  cString wrapped;
+  int lines;
+  cWrappedText(const char *Text, const cFont *Font, int Width, const char *Wrapped, int Lines);
+  bool Matches(const char *Text, const cFont *Font, int Width) const;
+  };
+
+cWrappedText::cWrappedText(const char *Text, const cFont *Font, int Width, const char *Wrapped, int Lines)
+{
+  font = Font;
+  fontName = Font->FontName();
+  size = Font->Size();
+  width = Width;
+  antiAliased = Setup.AntiAlias;
+  text = Text;
+  wrapped = Wrapped;
+  lines = Lines;
+}
+
+bool cWrappedText::Matches(const char *Text, const cFont *Font, int Width) const
+{
+  return font == Font && width == Width && antiAliased == bool(Setup.AntiAlias) && size == Font->Size()
+      && strcmp(fontName, Font->FontName()) == 0 && strcmp(text, Text) == 0;
+}
+
+static cMutex WrappedTextsMutex;
+static cList<cWrappedText> WrappedTexts; // the most recently used text comes first
+
 cTextWrapper::cTextWrapper(void)
 {
   text = eol = NULL;
@@ -567,9 +831,25 @@ void cTextWrapper::Set(const char *Text, const cFont *Font, int Width)
   if (Width <= 0)
      return;
 
+  cMutexLock MutexLock(&WrappedTextsMutex);
+  for (cWrappedText *t = WrappedTexts.First(); t; t = WrappedTexts.Next(t)) {
+      if (t->Matches(Text, Font, Width)) {
+         free(text);
+         text = strdup(t->wrapped);
+         lines = t->lines;
+         if (t != WrappedTexts.First()) {
+            WrappedTexts.Del(t, false);
+            WrappedTexts.Ins(t);
+            }
+         return;
+         }
+      }
+
   char *Blank = NULL;
   char *Delim = NULL;
   int w = 0;
+  int Widths[256]; // advances of the first 256 characters, as they are needed
+  memset(Widths, 0xFF, sizeof(Widths)); // initializes the array with negative values
 
   stripspace(text); // strips trailing newlines
 
@@ -585,7 +865,13 @@ void cTextWrapper::Set(const char *Text, const cFont *Font, int Width)
          }
       else if (sl == 1 && isspace(sym))
          Blank = p;
-      int cw = Font->Width(sym);
+      int cw;
+      if (sym < 256) {
+         if ((cw = Widths[sym]) < 0)
+            cw = Widths[sym] = Font->Width(sym);
+         }
+      else
+         cw = Font->Width(sym);
       if (w + cw > Width) {
          if (Blank) {
             *Blank = '\n';
@@ -615,6 +901,9 @@ void cTextWrapper::Set(const char *Text, const cFont *Font, int Width)
          }
       p += sl;
       }
+  WrappedTexts.Ins(new cWrappedText(Text, Font, Width, text, lines));
+  while (WrappedTexts.Count() > TEXTWRAPPERCACHESIZE)
+        WrappedTexts.Del(WrappedTexts.Last());
 }
 
 const char *cTextWrapper::Text(void)
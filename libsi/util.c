@@ -264,12 +264,40 @@ u_int32_t CRC32::crc_table[256] = {
    0x933eb0bb, 0x97ffad0c, 0xafb010b1, 0xab710d06, 0xa6322bdf, 0xa2f33668,
    0xbcb4666d, 0xb8757bda, 0xb5365d03, 0xb1f740b4};
 
+u_int32_t CRC32::crc_slices[8][256];
+
+void CRC32::initSlices() {
+   for (int i=0; i<256; i++) {
+      u_int32_t c=crc_table[i];
+      crc_slices[0][i]=c;
+      for (int k=1; k<8; k++) {
+         c = (c << 8) ^ crc_table[c >> 24];
+         crc_slices[k][i]=c;
+      }
+   }
+}
+
+//fills the slice tables before any section can be checked
+class CRC32Init {
+public:
+   CRC32Init() { CRC32::initSlices(); }
+};
+
+static CRC32Init crc32Init;
+
 u_int32_t CRC32::crc32 (const char *d, int len, u_int32_t crc)
 {
-   register int i;
    const unsigned char *u=(unsigned char*)d; // Saves '& 0xff'
 
-   for (i=0; i<len; i++)
+   //process eight bytes per step, since every PSI/SI section goes through here
+   for (; len >= 8; len -= 8, u += 8) {
+      crc ^= (u[0] << 24) | (u[1] << 16) | (u[2] << 8) | u[3];
+      crc = crc_slices[7][crc >> 24] ^ crc_slices[6][(crc >> 16) & 0xff]
+          ^ crc_slices[5][(crc >> 8) & 0xff] ^ crc_slices[4][crc & 0xff]
+          ^ crc_slices[3][u[4]] ^ crc_slices[2][u[5]]
+          ^ crc_slices[1][u[6]] ^ crc_slices[0][u[7]];
+   }
+   while (len-- > 0)
       crc = (crc << 8) ^ crc_table[((crc >> 24) ^ *u++)];
 
    return crc;
@@ -152,6 +152,11 @@ public:
    static u_int32_t crc32(const char *d, int len, u_int32_t CRCvalue);
 protected:
    static u_int32_t crc_table[256];
+   //tables for processing eight bytes at a time ("slicing-by-8"),
+   //crc_slices[0] is the same as crc_table
+   static u_int32_t crc_slices[8][256];
+   static void initSlices();
+   friend class CRC32Init;
 
    const char *data;
    int length;
@@ -96,6 +96,7 @@ void cNitFilter::Process(u_short Pid, u_char Tid, const u_char *Data, int Length
      return;
   if (!Channels.Lock(true, 10))
      return;
+  Channels.BeginUpdate();
   SI::NIT::TransportStream ts;
   for (SI::Loop::Iterator it; nit.transportStreamLoop.getNext(ts, it); ) {
       SI::Descriptor *d;
@@ -357,5 +358,6 @@ void cNitFilter::Process(u_short Pid, u_char Tid, const u_char *Data, int Length
           delete d;
           }
       }
+  Channels.EndUpdate();
   Channels.Unlock();
 }
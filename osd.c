@@ -112,16 +112,78 @@ tColor AlphaBlend(tColor ColorFg, tColor ColorBg, uint8_t AlphaLayer)
 }
 #endif
 
+// Blends a horizontal span of Count pixels from Source onto Dest.
+// In a typical OSD most pixels of a layer are either fully transparent or fully
+// opaque, so runs of these are skipped or copied as a whole instead of going
+// through AlphaBlend() for every single pixel:
+static void AlphaBlendSpan(tColor *Dest, const tColor *Source, int Count, uint8_t AlphaLayer)
+{
+  const tColor *End = Source + Count;
+  while (Source < End) {
+        const tColor *s = Source;
+        if ((*s >> 24) == ALPHA_TRANSPARENT) {
+           while (++s < End && (*s >> 24) == ALPHA_TRANSPARENT)
+                 ;
+           Dest += s - Source;
+           }
+        else if (AlphaLayer == ALPHA_OPAQUE && IS_OPAQUE(*s)) {
+           while (++s < End && IS_OPAQUE(*s))
+                 ;
+           memcpy(Dest, Source, (s - Source) * sizeof(tColor));
+           Dest += s - Source;
+           }
+        else {
+           *Dest = AlphaBlend(*s++, *Dest, AlphaLayer);
+           Dest++;
+           }
+        Source = s;
+        }
+}
+
 // --- cPalette --------------------------------------------------------------
 
+#define INDEXCACHEBITS 12 // the cache of looked up colors has 2^INDEXCACHEBITS entries
+#define INDEXCACHESIZE (1 << INDEXCACHEBITS)
+
 cPalette::cPalette(int Bpp)
 {
+  cachedColors = NULL;
+  cachedIndexes = NULL;
   SetBpp(Bpp);
   SetAntiAliasGranularity(10, 10);
 }
 
+cPalette::cPalette(const cPalette &Palette)
+{
+  cachedColors = NULL;
+  cachedIndexes = NULL;
+  *this = Palette;
+}
+
 cPalette::~cPalette()
 {
+  free(cachedColors);
+  free(cachedIndexes);
+}
+
+cPalette& cPalette::operator= (const cPalette &Palette)
+{
+  if (&Palette != this) {
+     memcpy(color, Palette.color, sizeof(color));
+     bpp = Palette.bpp;
+     maxColors = Palette.maxColors;
+     numColors = Palette.numColors;
+     modified = Palette.modified;
+     antiAliasGranularity = Palette.antiAliasGranularity;
+     InvalidateIndexCache();
+     }
+  return *this;
+}
+
+void cPalette::InvalidateIndexCache(void)
+{
+  if (cachedIndexes)
+     memset(cachedIndexes, 0xFF, INDEXCACHESIZE * sizeof(int16_t)); // initializes the array with negative values
 }
 
 void cPalette::SetAntiAliasGranularity(uint FixedColors, uint BlendColors)
@@ -139,9 +201,28 @@ void cPalette::Reset(void)
 {
   numColors = 0;
   modified = false;
+  InvalidateIndexCache();
 }
 
 int cPalette::Index(tColor Color)
+{
+  // Converting a bitmap or a true color image looks up the same colors over
+  // and over again, so the results are cached until the palette changes:
+  int Slot = (Color * 2654435769U) >> (32 - INDEXCACHEBITS);
+  if (!cachedIndexes) {
+     cachedColors = MALLOC(tColor, INDEXCACHESIZE);
+     cachedIndexes = MALLOC(int16_t, INDEXCACHESIZE);
+     InvalidateIndexCache();
+     }
+  else if (cachedIndexes[Slot] >= 0 && cachedColors[Slot] == Color)
+     return cachedIndexes[Slot];
+  int i = FindIndex(Color);
+  cachedColors[Slot] = Color;
+  cachedIndexes[Slot] = i;
+  return i;
+}
+
+int cPalette::FindIndex(tColor Color)
 {
   // Check if color is already defined:
   for (int i = 0; i < numColors; i++) {
@@ -156,6 +237,7 @@ int cPalette::Index(tColor Color)
   if (numColors < maxColors) {
      color[numColors++] = Color;
      modified = true;
+     InvalidateIndexCache();
      return numColors - 1;
      }
   // Out of colors, so any close color must do:
@@ -176,9 +258,12 @@ void cPalette::SetColor(int Index, tColor Color)
         numColors = Index + 1;
         modified = true;
         }
+     else if (color[Index] != Color)
+        modified = true;
      else
-        modified |= color[Index] != Color;
+        return;
      color[Index] = Color;
+     InvalidateIndexCache();
      }
 }
 
@@ -210,13 +295,24 @@ void cPalette::Replace(const cPalette &Palette)
   for (int i = 0; i < Palette.numColors; i++)
       SetColor(i, Palette.color[i]);
   numColors = Palette.numColors;
+  InvalidateIndexCache();
   antiAliasGranularity = Palette.antiAliasGranularity;
 }
 
-tColor cPalette::Blend(tColor ColorFg, tColor ColorBg, uint8_t Level) const
+uint8_t cPalette::BlendLevel(uint8_t Level) const
 {
   if (antiAliasGranularity > 0)
      Level = uint8_t(int(Level / antiAliasGranularity + 0.5) * antiAliasGranularity);
+  return Level;
+}
+
+tColor cPalette::Blend(tColor ColorFg, tColor ColorBg, uint8_t Level) const
+{
+  return BlendColors(ColorFg, ColorBg, BlendLevel(Level));
+}
+
+tColor cPalette::BlendColors(tColor ColorFg, tColor ColorBg, uint8_t Level)
+{
   int Af = (ColorFg & 0xFF000000) >> 24;
   int Rf = (ColorFg & 0x00FF0000) >> 16;
   int Gf = (ColorFg & 0x0000FF00) >>  8;
@@ -831,19 +927,20 @@ cBitmap *cBitmap::Scaled(double FactorX, double FactorY, bool AntiAlias)
   cBitmap *b = new cBitmap(int(round(Width() * FactorX)), int(round(Height() * FactorY)), Bpp(), X0(), Y0());
   int RatioX = (Width() << 16) / b->Width();
   int RatioY = (Height() << 16) / b->Height();
+  // The source column of each destination column is the same in every row:
+  int SourceXs[b->Width()];
+  for (int x = 0, SourceX = 0; x < b->Width(); x++, SourceX += RatioX)
+      SourceXs[x] = SourceX;
   if (!AntiAlias || FactorX <= 1.0 && FactorY <= 1.0) {
      // Downscaling - no anti-aliasing:
      b->Replace(*this); // copy palette
      tIndex *DestRow = b->bitmap;
      int SourceY = 0;
      for (int y = 0; y < b->Height(); y++) {
-         int SourceX = 0;
          tIndex *SourceRow = bitmap + (SourceY >> 16) * Width();
          tIndex *Dest = DestRow;
-         for (int x = 0; x < b->Width(); x++) {
-             *Dest++ = SourceRow[SourceX >> 16];
-             SourceX += RatioX;
-             }
+         for (int x = 0; x < b->Width(); x++)
+             *Dest++ = SourceRow[SourceXs[x] >> 16];
          SourceY += RatioY;
          DestRow += b->Width();
          }
@@ -852,19 +949,44 @@ cBitmap *cBitmap::Scaled(double FactorX, double FactorY, bool AntiAlias)
      // Upscaling - anti-aliasing:
      b->SetBpp(8);
      b->Replace(*this); // copy palette (must be done *after* SetBpp()!)
+     // The horizontal blending only depends on the source row, so it is done
+     // once for each of the two source rows that are currently needed, and
+     // the destination rows only need to blend these vertically:
+     int sx[b->Width()];
+     uint8_t BlendX[b->Width()];
+     for (int x = 0; x < b->Width(); x++) {
+         sx[x] = max(min(SourceXs[x] >> 16, Width() - 2), 0);
+         BlendX[x] = b->BlendLevel(0xFF - ((SourceXs[x] >> 8) & 0xFF));
+         }
+     tColor Rows[2][b->Width()];
+     tColor *Row1 = Rows[0];
+     tColor *Row2 = Rows[1];
+     int Row1y = -1;
      int SourceY = 0;
+     tIndex *Dest = b->bitmap;
      for (int y = 0; y < b->Height(); y++) {
-         int SourceX = 0;
-         int sy = min(SourceY >> 16, Height() - 2);
-         uint8_t BlendY = 0xFF - ((SourceY >> 8) & 0xFF);
+         int sy = max(min(SourceY >> 16, Height() - 2), 0);
+         if (sy != Row1y) {
+            if (Row1y >= 0 && sy == Row1y + 1) {
+               tColor *r = Row1;
+               Row1 = Row2;
+               Row2 = r;
+               }
+            else
+               ScaleRow(Row1, sy, sx, BlendX, b->Width());
+            ScaleRow(Row2, min(sy + 1, Height() - 1), sx, BlendX, b->Width());
+            Row1y = sy;
+            }
+         uint8_t BlendY = b->BlendLevel(0xFF - ((SourceY >> 8) & 0xFF));
+         tColor LastColor = 0;
+         int LastIndex = -1;
          for (int x = 0; x < b->Width(); x++) {
-             int sx = min(SourceX >> 16, Width() - 2);
-             uint8_t BlendX = 0xFF - ((SourceX >> 8) & 0xFF);
-             tColor c1 = b->Blend(GetColor(sx, sy),     GetColor(sx + 1, sy),     BlendX);
-             tColor c2 = b->Blend(GetColor(sx, sy + 1), GetColor(sx + 1, sy + 1), BlendX);
-             tColor c3 = b->Blend(c1, c2, BlendY);
-             b->DrawPixel(x + X0(), y + Y0(), c3);
-             SourceX += RatioX;
+             tColor c = Row1[x] == Row2[x] ? Row1[x] : BlendColors(Row1[x], Row2[x], BlendY);
+             if (c != LastColor || LastIndex < 0) {
+                LastColor = c;
+                LastIndex = b->Index(c);
+                }
+             *Dest++ = LastIndex;
              }
          SourceY += RatioY;
          }
@@ -872,6 +994,16 @@ cBitmap *cBitmap::Scaled(double FactorX, double FactorY, bool AntiAlias)
   return b;
 }
 
+void cBitmap::ScaleRow(tColor *Row, int y, const int *SourceX, const uint8_t *BlendX, int Width) const
+{
+  const tIndex *s = Data(0, y);
+  bool Wide = width > 1;
+  for (int x = 0; x < Width; x++) {
+      const tIndex *p = s + SourceX[x];
+      Row[x] = BlendColors(Color(p[0]), Color(p[Wide]), BlendX[x]);
+      }
+}
+
 // --- cRect -----------------------------------------------------------------
 
 const cRect cRect::Null;
@@ -1515,13 +1647,7 @@ void cPixmapMemory::Render(const cPixmap *Pixmap, const cRect &Source, const cPo
               const tColor *ps = pm->data + ws * s.Top() + s.Left();
               tColor *pd = data + wd * d.Top() + d.Left();
               for (int y = d.Height(); y-- > 0; ) {
-                  const tColor *cs = ps;
-                  tColor *cd = pd;
-                  for (int x = d.Width(); x-- > 0; ) {
-                      *cd = AlphaBlend(*cs, *cd, a);
-                      cs++;
-                      cd++;
-                      }
+                  AlphaBlendSpan(pd, ps, d.Width(), a);
                   ps += ws;
                   pd += wd;
                   }
@@ -1579,6 +1705,12 @@ void cPixmapMemory::Scroll(const cPoint &Dest, const cRect &Source)
            int w = d.Width() * sizeof(tColor);
            const tColor *ps = data + ws * s.Top() + s.Left();
            tColor *pd = data + wd * d.Top() + d.Left();
+           if (d.Top() > s.Top()) {
+              // Scrolling down, so the lines must be copied from the bottom up:
+              ps += ws * (d.Height() - 1);
+              pd += wd * (d.Height() - 1);
+              ws = wd = -ws;
+              }
            for (int y = d.Height(); y-- > 0; ) {
                memmove(pd, ps, w); // source and destination might overlap!
                ps += ws;
@@ -1603,6 +1735,239 @@ void cPixmapMemory::Pan(const cPoint &Dest, const cRect &Source)
   Unlock();
 }
 
+// --- cTileRenderer ---------------------------------------------------------
+
+// Large regions of a true color OSD are rendered in tiles by several threads
+// in parallel. Each tile is small enough for the data of all its layers to
+// fit into the CPU cache, and the layers below an opaque pixmap that covers
+// an entire tile are skipped.
+
+static int Area(const cRect &Rect)
+{
+  return Rect.Width() * Rect.Height();
+}
+
+#define OSDTILEWIDTH         512 // pixels
+#define OSDTILEHEIGHT         32 // pixels
+#define OSDTILEMINAREA (512 * 512) // smaller regions are rendered directly
+#define OSDTILETHREADS         4 // maximum number of threads, including the caller's
+
+class cTileRenderer;
+
+class cTileRenderThread : public cThread {
+private:
+  cTileRenderer *tileRenderer;
+protected:
+  virtual void Action(void);
+public:
+  cTileRenderThread(cTileRenderer *TileRenderer);
+  virtual ~cTileRenderThread();
+  };
+
+class cTileRenderer {
+private:
+  cMutex mutex;
+  cCondVar workAvailable;
+  cCondVar workDone;
+  cVector<cTileRenderThread *> threads;
+  int numThreads; // -1 = not yet initialized
+  cPixmapMemory *pixmap;
+  cRect region;
+  const cVector<cPixmap *> *pixmaps;
+  int tilesX;
+  int numTiles;
+  int nextTile;
+  int pendingTiles;
+  bool CanRender(const cRect &Region, const cVector<cPixmap *> &Pixmaps);
+  bool Covers(const cPixmap *Pixmap, const cRect &Tile);
+  void Compose(const cPixmap *Pixmap, const cRect &Tile);
+  void RenderTile(int Tile);
+  static tColor *Data(const cPixmapMemory *Pixmap, int X, int Y);
+public:
+  cTileRenderer(void);
+  ~cTileRenderer();
+  bool Render(cPixmapMemory *Pixmap, const cRect &Region, const cVector<cPixmap *> &Pixmaps);
+       ///< Renders the given Pixmaps into the given Region (in OSD coordinates) of
+       ///< Pixmap, which must already be cleared there. Returns false if the region
+       ///< is too small, the pixmaps can't be rendered in tiles, or there is only
+       ///< one CPU.
+  void RenderTiles(bool Wait);
+  };
+
+static cTileRenderer TileRenderer;
+
+cTileRenderThread::cTileRenderThread(cTileRenderer *TileRenderer)
+:cThread("osd tile renderer")
+{
+  tileRenderer = TileRenderer;
+}
+
+cTileRenderThread::~cTileRenderThread()
+{
+  Cancel(3);
+}
+
+void cTileRenderThread::Action(void)
+{
+  while (Running())
+        tileRenderer->RenderTiles(true);
+}
+
+cTileRenderer::cTileRenderer(void)
+{
+  numThreads = -1;
+  pixmap = NULL;
+  pixmaps = NULL;
+  tilesX = numTiles = nextTile = pendingTiles = 0;
+}
+
+cTileRenderer::~cTileRenderer()
+{
+  for (int i = 0; i < threads.Size(); i++)
+      delete threads[i];
+}
+
+bool cTileRenderer::CanRender(const cRect &Region, const cVector<cPixmap *> &Pixmaps)
+{
+  if (Area(Region) < OSDTILEMINAREA)
+     return false;
+  for (int i = 0; i < Pixmaps.Size(); i++) {
+      if (const cPixmap *pm = Pixmaps[i]) {
+         if (pm->Layer() >= 0 && pm->ViewPort().Intersects(Region)) {
+            if (!dynamic_cast<const cPixmapMemory *>(pm))
+               return false;
+            if (pm->Tile() && (pm->DrawPort().Point() != cPoint(0, 0) || pm->DrawPort().Size() < pm->ViewPort().Size()))
+               return false; // tiled pixmaps are left to cPixmap::DrawPixmap()
+            }
+         }
+      }
+  if (numThreads < 0) {
+     numThreads = constrain(int(sysconf(_SC_NPROCESSORS_ONLN)), 1, OSDTILETHREADS) - 1;
+     for (int i = 0; i < numThreads; i++) {
+         threads.Append(new cTileRenderThread(this));
+         threads[i]->Start();
+         }
+     }
+  return numThreads > 0;
+}
+
+tColor *cTileRenderer::Data(const cPixmapMemory *Pixmap, int X, int Y)
+{
+  // Returns a pointer to the pixel at the given OSD coordinates:
+  const cRect &ViewPort = Pixmap->ViewPort();
+  const cRect &DrawPort = Pixmap->DrawPort();
+  return Pixmap->data + (Y - ViewPort.Y() - DrawPort.Y()) * DrawPort.Width() + X - ViewPort.X() - DrawPort.X();
+}
+
+bool cTileRenderer::Covers(const cPixmap *Pixmap, const cRect &Tile)
+{
+  if (Pixmap->Alpha() != ALPHA_OPAQUE)
+     return false;
+  const cPixmapMemory *pm = (const cPixmapMemory *)Pixmap;
+  cRect Visible = pm->DrawPort().Shifted(pm->ViewPort().Point()).Intersected(pm->ViewPort());
+  if (Visible.Intersected(Tile) != Tile)
+     return false;
+  for (int y = Tile.Top(); y <= Tile.Bottom(); y++) {
+      const tColor *ps = Data(pm, Tile.Left(), y);
+      for (int x = Tile.Width(); x-- > 0; ) {
+          if (!IS_OPAQUE(*ps++))
+             return false;
+          }
+      }
+  return true;
+}
+
+void cTileRenderer::Compose(const cPixmap *Pixmap, const cRect &Tile)
+{
+  // Does the same as cPixmap::DrawPixmap() for an untiled pixmap, without locking:
+  const cPixmapMemory *pm = (const cPixmapMemory *)Pixmap;
+  if (pm->Layer() > 0 && pm->Alpha() == ALPHA_TRANSPARENT)
+     return;
+  cRect Source = pm->DrawPort().Shifted(pm->ViewPort().Point()).Intersected(pm->ViewPort()).Intersected(Tile);
+  if (!Source.IsEmpty()) {
+     const tColor *ps = Data(pm, Source.Left(), Source.Top());
+     tColor *pd = Data(pixmap, Source.Left(), Source.Top());
+     int ws = pm->DrawPort().Width();
+     int wd = pixmap->DrawPort().Width();
+     for (int y = Source.Height(); y-- > 0; ) {
+         if (pm->Layer() == 0)
+            memcpy(pd, ps, Source.Width() * sizeof(tColor));
+         else
+            AlphaBlendSpan(pd, ps, Source.Width(), pm->Alpha());
+         ps += ws;
+         pd += wd;
+         }
+     }
+}
+
+void cTileRenderer::RenderTile(int Tile)
+{
+  cRect r(region.X() + Tile % tilesX * OSDTILEWIDTH, region.Y() + Tile / tilesX * OSDTILEHEIGHT, OSDTILEWIDTH, OSDTILEHEIGHT);
+  r = r.Intersected(region);
+  // Skip the layers below an opaque pixmap that covers the entire tile:
+  int FirstLayer = 0;
+  for (int Layer = MAXPIXMAPLAYERS - 1; Layer > 0 && !FirstLayer; Layer--) {
+      for (int i = 0; i < pixmaps->Size(); i++) {
+          if (const cPixmap *pm = (*pixmaps)[i]) {
+             if (pm->Layer() == Layer && Covers(pm, r)) {
+                FirstLayer = Layer;
+                break;
+                }
+             }
+          }
+      }
+  for (int Layer = FirstLayer; Layer < MAXPIXMAPLAYERS; Layer++) {
+      for (int i = 0; i < pixmaps->Size(); i++) {
+          if (const cPixmap *pm = (*pixmaps)[i]) {
+             if (pm->Layer() == Layer)
+                Compose(pm, r);
+             }
+          }
+      }
+}
+
+void cTileRenderer::RenderTiles(bool Wait)
+{
+  cMutexLock MutexLock(&mutex);
+  if (Wait && nextTile >= numTiles)
+     workAvailable.TimedWait(mutex, 1000);
+  while (nextTile < numTiles) {
+        int Tile = nextTile++;
+        mutex.Unlock();
+        RenderTile(Tile);
+        mutex.Lock();
+        if (--pendingTiles == 0)
+           workDone.Broadcast();
+        }
+}
+
+bool cTileRenderer::Render(cPixmapMemory *Pixmap, const cRect &Region, const cVector<cPixmap *> &Pixmaps)
+{
+  // The caller holds the lock on the pixmaps, so none of them can be
+  // modified while they are being rendered:
+  if (!CanRender(Region, Pixmaps))
+     return false;
+  mutex.Lock();
+  pixmap = Pixmap;
+  region = Region;
+  pixmaps = &Pixmaps;
+  tilesX = (Region.Width() + OSDTILEWIDTH - 1) / OSDTILEWIDTH;
+  numTiles = pendingTiles = tilesX * ((Region.Height() + OSDTILEHEIGHT - 1) / OSDTILEHEIGHT);
+  nextTile = 0;
+  workAvailable.Broadcast();
+  mutex.Unlock();
+  RenderTiles(false); // the calling thread does its share of the work
+  mutex.Lock();
+  while (pendingTiles > 0)
+        workDone.Wait(mutex);
+  numTiles = nextTile = 0;
+  pixmap = NULL;
+  pixmaps = NULL;
+  mutex.Unlock();
+  Pixmap->MarkDrawPortDirty(Region.Shifted(-Pixmap->ViewPort().Point()));
+  return true;
+}
+
 // --- cOsd ------------------------------------------------------------------
 
 static const char *OsdErrorTexts[] = {
@@ -1631,6 +1996,8 @@ cOsd::cOsd(int Left, int Top, uint Level)
   savedBitmap = NULL;
   numBitmaps = 0;
   savedPixmap = NULL;
+  numDamage = 0;
+  renderBuffer = NULL;
   left = Left;
   top = Top;
   width = height = 0;
@@ -1652,6 +2019,7 @@ cOsd::~cOsd()
       delete bitmaps[i];
   delete savedBitmap;
   delete savedPixmap;
+  delete renderBuffer;
   for (int i = 0; i < pixmaps.Size(); i++)
       delete pixmaps[i];
   for (int i = 0; i < Osds.Size(); i++) {
@@ -1726,24 +2094,78 @@ cPixmap *cOsd::AddPixmap(cPixmap *Pixmap)
   return Pixmap;
 }
 
+void cOsd::AddDamage(const cRect &Rect)
+{
+  cRect r = Rect;
+  for (;;) {
+      // Merge with a region that overlaps, or that is so close that rendering the
+      // area in between costs less than rendering the two regions separately:
+      bool Merged = false;
+      for (int i = 0; i < numDamage; i++) {
+          cRect c = r.Combined(damage[i]);
+          if (r.Intersects(damage[i]) || Area(c) * 4 <= (Area(r) + Area(damage[i])) * 5) {
+             r = c;
+             damage[i] = damage[--numDamage];
+             Merged = true;
+             break;
+             }
+          }
+      if (Merged)
+         continue; // the combined region may now overlap other regions
+      if (numDamage < MAXOSDDAMAGE)
+         break;
+      // Too many regions, so merge with the one that grows the least:
+      int Best = 0;
+      int MinGrowth = INT_MAX;
+      for (int i = 0; i < numDamage; i++) {
+          int Growth = Area(r.Combined(damage[i])) - Area(damage[i]);
+          if (Growth < MinGrowth) {
+             MinGrowth = Growth;
+             Best = i;
+             }
+          }
+      r.Combine(damage[Best]);
+      damage[Best] = damage[--numDamage];
+      }
+  damage[numDamage++] = r;
+}
+
+void cOsd::CollectDamage(void)
+{
+  for (int i = 0; i < pixmaps.Size(); i++) {
+      if (cPixmap *pm = pixmaps[i]) {
+         if (!pm->DirtyViewPort().IsEmpty()) {
+            AddDamage(pm->DirtyViewPort());
+            pm->SetClean();
+            }
+         }
+      }
+}
+
+void cOsd::RenderRegion(cPixmapMemory *Pixmap, const cRect &Region)
+{
+  if (TileRenderer.Render(Pixmap, Region, pixmaps))
+     return;
+  // Render the individual pixmaps into the resulting pixmap:
+  for (int Layer = 0; Layer < MAXPIXMAPLAYERS; Layer++) {
+      for (int i = 0; i < pixmaps.Size(); i++) {
+          if (cPixmap *pm = pixmaps[i]) {
+             if (pm->Layer() == Layer)
+                Pixmap->DrawPixmap(pm, Region);
+             }
+          }
+      }
+}
+
 cPixmapMemory *cOsd::RenderPixmaps(void)
 {
   cPixmapMemory *Pixmap = NULL;
   if (isTrueColor) {
      LOCK_PIXMAPS;
-     // Collect overlapping dirty rectangles:
-     cRect d;
-     for (int i = 0; i < pixmaps.Size(); i++) {
-         if (cPixmap *pm = pixmaps[i]) {
-            if (!pm->DirtyViewPort().IsEmpty()) {
-               if (d.IsEmpty() || d.Intersects(pm->DirtyViewPort())) {
-                  d.Combine(pm->DirtyViewPort());
-                  pm->SetClean();
-                  }
-               }
-            }
-         }
-     if (!d.IsEmpty()) {
+     // Collect the dirty regions and render one of them:
+     CollectDamage();
+     if (numDamage) {
+        cRect d = damage[--numDamage];
 //#define DebugDirty
 #ifdef DebugDirty
         static cRect OldDirty;
@@ -1753,15 +2175,7 @@ cPixmapMemory *cOsd::RenderPixmaps(void)
 #endif
         Pixmap = new cPixmapMemory(0, d);
         Pixmap->Clear();
-        // Render the individual pixmaps into the resulting pixmap:
-        for (int Layer = 0; Layer < MAXPIXMAPLAYERS; Layer++) {
-            for (int i = 0; i < pixmaps.Size(); i++) {
-                if (cPixmap *pm = pixmaps[i]) {
-                   if (pm->Layer() == Layer)
-                   Pixmap->DrawPixmap(pm, d);
-                   }
-                }
-            }
+        RenderRegion(Pixmap, d);
 #ifdef DebugDirty
         cPixmapMemory DirtyIndicator(7, NewDirty);
         static tColor DirtyIndicatorColors[] = { 0x7FFFFF00, 0x7F00FFFF };
@@ -1775,6 +2189,35 @@ cPixmapMemory *cOsd::RenderPixmaps(void)
   return Pixmap;
 }
 
+const cPixmapMemory *cOsd::RenderPixmaps(const cRect *&Regions, int &NumRegions)
+{
+  NumRegions = 0;
+  Regions = renderedRegions;
+  if (isTrueColor) {
+     LOCK_PIXMAPS;
+     CollectDamage();
+     if (numDamage) {
+        cRect r(0, 0, width, height);
+        if (!renderBuffer || renderBuffer->ViewPort() != r) {
+           delete renderBuffer;
+           renderBuffer = new cPixmapMemory(0, r);
+           }
+        for (int i = 0; i < numDamage; i++) {
+            cRect d = damage[i].Intersected(r);
+            if (!d.IsEmpty()) {
+               renderBuffer->DrawRectangle(d, clrTransparent);
+               RenderRegion(renderBuffer, d);
+               renderedRegions[NumRegions++] = d;
+               }
+            }
+        numDamage = 0;
+        if (NumRegions)
+           return renderBuffer;
+        }
+     }
+  return NULL;
+}
+
 eOsdError cOsd::CanHandleAreas(const tArea *Areas, int NumAreas)
 {
   if (NumAreas > MAXOSDAREAS)
@@ -1946,17 +2389,41 @@ void cOsd::DrawSlope(int x1, int y1, int x2, int y2, tColor Color, int Type)
      }
 }
 
+bool cOsd::MoveRectangle(int x1, int y1, int x2, int y2, int Dx, int Dy)
+{
+  if (isTrueColor) {
+     cRect r(x1, y1, x2 - x1 + 1, y2 - y1 + 1);
+     cRect Source = r.Intersected(r.Shifted(-Dx, -Dy)); // the part that stays within the rectangle
+     if (!Source.IsEmpty())
+        pixmaps[0]->Scroll(Source.Point().Shifted(Dx, Dy), Source);
+     return true;
+     }
+  return false;
+}
+
 void cOsd::Flush(void)
 {
 }
 
 // --- cOsdProvider ----------------------------------------------------------
 
+class cNamedImage : public cListObject {
+public:
+  cString name;
+  int handle;
+  int size;
+  int users; // the number of GetImage() calls that haven't been followed by ReleaseImage() yet
+  bool dropped; // the image shall be dropped once it is no longer in use
+  cNamedImage(const char *Name, int Handle, int Size) { name = Name; handle = Handle; size = Size; users = 0; dropped = false; }
+  };
+
 cOsdProvider *cOsdProvider::osdProvider = NULL;
 int cOsdProvider::oldWidth = 0;
 int cOsdProvider::oldHeight = 0;
 double cOsdProvider::oldAspect = 1.0;
 cImage *cOsdProvider::images[MAXOSDIMAGES] = { NULL };
+cList<cNamedImage> cOsdProvider::namedImages; // the most recently used image comes first
+int cOsdProvider::namedImagesSize = 0;
 
 cOsdProvider::cOsdProvider(void)
 {
@@ -1966,6 +2433,11 @@ cOsdProvider::cOsdProvider(void)
 
 cOsdProvider::~cOsdProvider()
 {
+  // The handles of named images are only valid with the provider that stored them
+  // (their data has already been dropped in Shutdown()):
+  LOCK_PIXMAPS;
+  namedImages.Clear();
+  namedImagesSize = 0;
   osdProvider = NULL;
 }
 
@@ -2060,14 +2532,95 @@ int cOsdProvider::StoreImage(const cImage &Image)
   return 0;
 }
 
+bool cOsdProvider::DropLeastRecentlyUsedImage(void)
+{
+  for (cNamedImage *ni = namedImages.Last(); ni; ni = namedImages.Prev(ni)) {
+      if (!ni->users) {
+         DropImage(ni->handle);
+         return true;
+         }
+      }
+  return false;
+}
+
+int cOsdProvider::StoreImage(const cImage &Image, const char *Name)
+{
+  LOCK_PIXMAPS;
+  for (cNamedImage *ni = namedImages.First(); ni; ni = namedImages.Next(ni)) {
+      if (!ni->dropped && strcmp(ni->name, Name) == 0) {
+         DropImage(ni->handle);
+         break;
+         }
+      }
+  int Size = Image.Width() * Image.Height() * sizeof(tColor);
+  while (namedImagesSize + Size > MAXOSDIMAGECACHE && DropLeastRecentlyUsedImage())
+        ;
+  int Handle = StoreImage(Image);
+  while (!Handle && DropLeastRecentlyUsedImage())
+        Handle = StoreImage(Image);
+  if (Handle) {
+     cNamedImage *ni = new cNamedImage(Name, Handle, Size);
+     ni->users++;
+     namedImages.Ins(ni);
+     namedImagesSize += Size;
+     }
+  return Handle;
+}
+
+int cOsdProvider::GetImage(const char *Name)
+{
+  LOCK_PIXMAPS;
+  for (cNamedImage *ni = namedImages.First(); ni; ni = namedImages.Next(ni)) {
+      if (!ni->dropped && strcmp(ni->name, Name) == 0) {
+         if (ni != namedImages.First()) {
+            namedImages.Del(ni, false);
+            namedImages.Ins(ni);
+            }
+         ni->users++;
+         return ni->handle;
+         }
+      }
+  return 0;
+}
+
+void cOsdProvider::ReleaseImage(int ImageHandle)
+{
+  LOCK_PIXMAPS;
+  for (cNamedImage *ni = namedImages.First(); ni; ni = namedImages.Next(ni)) {
+      if (ni->handle == ImageHandle) {
+         if (ni->users > 0 && --ni->users == 0 && ni->dropped)
+            DropImage(ImageHandle);
+         break;
+         }
+      }
+}
+
 void cOsdProvider::DropImage(int ImageHandle)
 {
+  LOCK_PIXMAPS;
+  for (cNamedImage *ni = namedImages.First(); ni; ni = namedImages.Next(ni)) {
+      if (ni->handle == ImageHandle) {
+         if (ni->users) {
+            ni->dropped = true; // ReleaseImage() will drop it
+            return;
+            }
+         namedImagesSize -= ni->size;
+         namedImages.Del(ni);
+         break;
+         }
+      }
   if (osdProvider)
      osdProvider->DropImageData(ImageHandle);
 }
 
 void cOsdProvider::Shutdown(void)
 {
+  if (osdProvider) {
+     // This can't be done in the destructor, where DropImageData() is no longer virtual:
+     LOCK_PIXMAPS;
+     for (cNamedImage *ni = namedImages.First(); ni; ni = namedImages.Next(ni))
+         osdProvider->DropImageData(ni->handle);
+     }
   delete osdProvider;
   osdProvider = NULL;
 }
@@ -2104,7 +2657,7 @@ void cTextScroller::Set(cOsd *Osd, int Left, int Top, int Width, int Height, con
   textWrapper.Set(Text, Font, Width);
   shown = min(Total(), height / font->Height());
   height = shown * font->Height(); // sets height to the actually used height, which may be less than Height
-  DrawText();
+  DrawText(0, shown);
 }
 
 void cTextScroller::Reset(void)
@@ -2112,22 +2665,22 @@ void cTextScroller::Reset(void)
   osd = NULL; // just makes sure it won't draw anything
 }
 
-void cTextScroller::DrawText(void)
+void cTextScroller::DrawText(int From, int To)
 {
   if (osd) {
-     for (int i = 0; i < shown; i++)
+     for (int i = From; i < To; i++)
          osd->DrawText(left, top + i * font->Height(), textWrapper.GetLine(offset + i), colorFg, colorBg, font, width);
      }
 }
 
 void cTextScroller::Scroll(bool Up, bool Page)
 {
+  int OldOffset = offset;
   if (Up) {
      if (CanScrollUp()) {
         offset -= Page ? shown : 1;
         if (offset < 0)
            offset = 0;
-        DrawText();
         }
      }
   else {
@@ -2135,7 +2688,20 @@ void cTextScroller::Scroll(bool Up, bool Page)
         offset += Page ? shown : 1;
         if (offset + shown > Total())
            offset = Total() - shown;
-        DrawText();
         }
      }
+  int Lines = offset - OldOffset;
+  if (Lines) {
+     // Lines that remain visible are moved rather than drawn again (which
+     // requires an opaque background, since each line's area is then
+     // entirely defined by its own text):
+     if (osd && abs(Lines) < shown && colorBg != clrTransparent && osd->MoveRectangle(left, top, left + width - 1, top + height - 1, 0, -Lines * font->Height())) {
+        if (Lines > 0)
+           DrawText(shown - Lines, shown);
+        else
+           DrawText(0, -Lines);
+        }
+     else
+        DrawText(0, shown);
+     }
 }
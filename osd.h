@@ -92,12 +92,25 @@ private:
   int maxColors, numColors;
   bool modified;
   double antiAliasGranularity;
+  tColor *cachedColors; ///< Colors recently looked up by Index() (allocated on demand).
+  int16_t *cachedIndexes; ///< The indexes of cachedColors, or -1 for unused entries.
+  int FindIndex(tColor Color);
+  void InvalidateIndexCache(void);
 protected:
   typedef tIndex tIndexes[MAXNUMCOLORS];
+  uint8_t BlendLevel(uint8_t Level) const;
+        ///< Returns the given blend Level, mapped to the limited range of levels
+        ///< set by SetAntiAliasGranularity() (see Blend()).
+  static tColor BlendColors(tColor ColorFg, tColor ColorBg, uint8_t Level);
+        ///< Does the same as Blend(), but uses the given Level as is.
 public:
   cPalette(int Bpp = 8);
         ///< Initializes the palette with the given color depth.
+  cPalette(const cPalette &Palette);
   virtual ~cPalette();
+  cPalette& operator= (const cPalette &Palette);
+        ///< Copies the colors and settings of Palette, but not its cache of
+        ///< looked up colors.
   void SetAntiAliasGranularity(uint FixedColors, uint BlendColors);
         ///< Allows the system to optimize utilization of the limited color
         ///< palette entries when generating blended colors for anti-aliasing.
@@ -172,6 +185,7 @@ private:
   int x0, y0;
   int width, height;
   int dirtyX1, dirtyY1, dirtyX2, dirtyY2;
+  void ScaleRow(tColor *Row, int y, const int *SourceX, const uint8_t *BlendX, int Width) const;
 public:
   cBitmap(int Width, int Height, int Bpp, int X0 = 0, int Y0 = 0);
        ///< Creates a bitmap with the given Width, Height and color depth (Bpp).
@@ -676,6 +690,7 @@ public:
 // values to store the pixmap.
 
 class cPixmapMemory : public cPixmap {
+  friend class cTileRenderer;
 private:
   tColor *data;
   bool panning;
@@ -701,6 +716,7 @@ public:
   };
 
 #define MAXOSDAREAS 16
+#define MAXOSDDAMAGE 8 // maximum number of separate dirty regions of an OSD
 
 /// The cOsd class is the interface to the "On Screen Display".
 /// An actual output device needs to derive from this class and implement
@@ -725,9 +741,16 @@ private:
   int numBitmaps;
   cPixmapMemory *savedPixmap;
   cVector<cPixmap *> pixmaps;
+  cRect damage[MAXOSDDAMAGE];
+  int numDamage;
+  cRect renderedRegions[MAXOSDDAMAGE];
+  cPixmapMemory *renderBuffer;
   int left, top, width, height;
   uint level;
   bool active;
+  void AddDamage(const cRect &Rect);
+  void CollectDamage(void);
+  void RenderRegion(cPixmapMemory *Pixmap, const cRect &Region);
 protected:
   cOsd(int Left, int Top, uint Level);
        ///< Initializes the OSD with the given coordinates.
@@ -775,6 +798,21 @@ protected:
        ///< If there are no dirty pixmaps, or if this is not a true color OSD,
        ///< this function returns NULL.
        ///< The caller must delete the returned pixmap after use.
+  const cPixmapMemory *RenderPixmaps(const cRect *&Regions, int &NumRegions);
+       ///< Renders the dirty parts of all pixmaps into a buffer that covers the
+       ///< entire OSD and is kept by the OSD from one call to the next, so that it
+       ///< doesn't have to be allocated every time. Upon return Regions points
+       ///< to an array of NumRegions non-overlapping rectangles (in OSD coordinates)
+       ///< that have been rendered and need to be displayed. The returned pixmap's
+       ///< view port and draw port are both at (0, 0) and have the size of the OSD,
+       ///< so each region can be taken from the pixmap's data at its own location.
+       ///< Dirty areas that are far apart from each other are kept in separate
+       ///< regions, in order to avoid re-rendering the parts of the OSD between
+       ///< them. The same locking rules as with RenderPixmaps() apply, and the
+       ///< returned data is only valid until the next call to this function.
+       ///< If there are no dirty pixmaps, or if this is not a true color OSD,
+       ///< this function returns NULL (and sets NumRegions to 0).
+       ///< The caller must not delete the returned pixmap.
 public:
   virtual ~cOsd();
        ///< Shuts down the OSD.
@@ -912,6 +950,14 @@ public:
        ///< 5: vertical,   rising,  upper
        ///< 6: vertical,   falling, lower
        ///< 7: vertical,   falling, upper
+  virtual bool MoveRectangle(int x1, int y1, int x2, int y2, int Dx, int Dy);
+       ///< Moves the contents of the rectangle defined by the upper left (x1, y1) and
+       ///< lower right (x2, y2) corners by Dx pixels horizontally and Dy pixels
+       ///< vertically. Only the area within that rectangle is changed. The part of
+       ///< it that is uncovered by the move keeps its previous contents and needs
+       ///< to be redrawn by the caller.
+       ///< Returns false if this OSD can't move its contents, in which case the
+       ///< caller needs to redraw the entire rectangle.
   virtual void Flush(void);
        ///< Actually commits all data to the OSD hardware.
        ///< Flush() should return as soon as possible.
@@ -926,9 +972,15 @@ public:
        ///<        MyOsdDrawPixmap(Left() + pm->ViewPort().X(), Top() + pm->ViewPort().Y(), pm->Data(), w, h, h * d);
        ///<        delete pm;
        ///<        }
+       ///<
+       ///< Alternatively it can use the variant of RenderPixmaps() that returns a
+       ///< list of regions in a buffer that is kept by the OSD.
   };
 
-#define MAXOSDIMAGES 64
+#define MAXOSDIMAGES 256
+#define MAXOSDIMAGECACHE (16 * 1024 * 1024) // maximum number of bytes of all images stored under a name
+
+class cNamedImage;
 
 class cOsdProvider {
   friend class cPixmapMemory;
@@ -938,6 +990,9 @@ private:
   static int oldHeight;
   static double oldAspect;
   static cImage *images[MAXOSDIMAGES];
+  static cList<cNamedImage> namedImages;
+  static int namedImagesSize;
+  static bool DropLeastRecentlyUsedImage(void);
 protected:
   virtual cOsd *CreateOsd(int Left, int Top, uint Level) = 0;
       ///< Returns a pointer to a newly created cOsd object, which will be located
@@ -986,9 +1041,31 @@ public:
       ///< space where they can be retrieved faster than using a cImage in each call.
       ///< If this is not a true color OSD, or if the image data can't be stored for
       ///< any reason, this function returns 0 and nothing is stored.
+  static int StoreImage(const cImage &Image, const char *Name);
+      ///< Stores the given Image like StoreImage(Image), and remembers it under the
+      ///< given Name, so that later it can be retrieved with GetImage(Name) instead
+      ///< of being loaded again. Name would typically consist of the image's file
+      ///< name and the size it has been scaled to (like "/logos/tv1.png:120x90").
+      ///< An image already stored under Name is replaced. If the images stored this
+      ///< way use up more than MAXOSDIMAGECACHE bytes, or there are no more free
+      ///< image handles, the least recently used ones that are not in use are
+      ///< dropped. The returned handle is in use (just like one returned by
+      ///< GetImage()) until it is given to ReleaseImage().
+  static int GetImage(const char *Name);
+      ///< Returns the handle of the image that has been stored under the given
+      ///< Name with StoreImage(), or 0 if there is no such image (any more).
+      ///< The image is marked as being in use, so that it isn't dropped (by
+      ///< any thread) before the caller calls ReleaseImage() with the returned
+      ///< handle, which should be done once the OSD the image has been drawn on
+      ///< has been flushed. A handle shall not be kept any longer, but rather be
+      ///< retrieved with GetImage() every time the image is drawn.
+  static void ReleaseImage(int ImageHandle);
+      ///< Releases an image handle returned by GetImage() or StoreImage(Image, Name).
   static void DropImage(int ImageHandle);
       ///< Drops the image referenced by the given ImageHandle. If ImageHandle
-      ///< has an invalid value, nothing happens.
+      ///< has an invalid value, nothing happens. If the image has been stored
+      ///< under a name and is currently in use, it is dropped once it has been
+      ///< released.
   static void Shutdown(void);
       ///< Shuts down the OSD provider facility by deleting the current OSD provider.
   };
@@ -1001,7 +1078,7 @@ private:
   tColor colorFg, colorBg;
   int offset, shown;
   cTextWrapper textWrapper;
-  void DrawText(void);
+  void DrawText(int From, int To);
 public:
   cTextScroller(void);
   cTextScroller(cOsd *Osd, int Left, int Top, int Width, int Height, const char *Text, const cFont *Font, tColor ColorFg, tColor ColorBg);
@@ -94,6 +94,7 @@ cOsdMenu::cOsdMenu(const char *Title, int c0, int c1, int c2, int c3, int c4)
   helpRed = helpGreen = helpYellow = helpBlue = NULL;
   helpDisplayed = false;
   status = NULL;
+  SetIndexed();
   if (!displayMenuCount++)
      SetDisplayMenu();
 }
@@ -17,7 +17,9 @@
 #include <math.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/inotify.h>
 #include <sys/stat.h>
+#include <sys/vfs.h>
 #include <unistd.h>
 #include "channels.h"
 #include "i18n.h"
@@ -66,6 +68,15 @@
 
 #define MAX_LINK_LEVEL  6
 
+#define RECORDINGSCACHEHASHSIZE  4096
+#define RECORDINGSCACHEREFRESH  86400 // seconds after which the 'last used' time of a cache entry is renewed
+#define RECORDINGSCACHEEXPIRE 2592000 // seconds after which an unused cache entry is dropped (30 days)
+
+#define VIDEODIRSCANNERS       4 // threads that scan the video directory in parallel
+
+#define WATCHERPOLLTIMEOUT  1000 // ms
+#define WATCHERBUFFERSIZE   KILOBYTE(16)
+
 int DirectoryPathMax = PATH_MAX - 1;
 int DirectoryNameMax = NAME_MAX;
 bool DirectoryEncoding = false;
@@ -1219,52 +1230,619 @@ int cRecording::FileSizeMB(void) const
   return fileSizeMB;
 }
 
-// --- cRecordings -----------------------------------------------------------
+// --- cRecordingsCache ------------------------------------------------------
 
-cRecordings Recordings;
+// The number of frames and the total file size of a recording are expensive
+// to determine, because this requires looking at the index file and at every
+// data file of the recording. Once a recording is complete, these values no
+// longer change, so they are kept in a cache file and are only determined
+// again if the recording's directory has been modified (or replaced) since.
 
-char *cRecordings::updateFileName = NULL;
+class cRecordingsCacheEntry : public cListObject {
+public:
+  char *fileName;
+  time_t mtime;
+  ino_t inode;
+  int numFrames;
+  int fileSizeMB;
+  time_t lastUsed;
+  cRecordingsCacheEntry(const char *FileName) { fileName = strdup(FileName); mtime = 0; inode = 0; numFrames = fileSizeMB = -1; lastUsed = 0; }
+  virtual ~cRecordingsCacheEntry() { free(fileName); }
+  };
 
-cRecordings::cRecordings(bool Deleted)
-:cThread("video directory scanner")
+class cRecordingsCache {
+private:
+  cMutex mutex;
+  char *fileName;
+  bool loaded;
+  bool modified;
+  cList<cRecordingsCacheEntry> entries;
+  cHash<cRecordingsCacheEntry> entriesHash;
+  static unsigned int HashKey(const char *FileName);
+  cRecordingsCacheEntry *Find(const char *FileName);
+  void Load(void);
+public:
+  cRecordingsCache(void);
+  ~cRecordingsCache();
+  void SetFileName(const char *FileName);
+  bool Get(const char *FileName, const struct stat &St, int &NumFrames, int &FileSizeMB);
+       ///< Returns the cached NumFrames and FileSizeMB of the recording in the
+       ///< directory FileName, provided St (as obtained from stat() on that
+       ///< directory) shows that it hasn't been modified since these values
+       ///< were stored with Put().
+  void Put(const char *FileName, const struct stat &St, int NumFrames, int FileSizeMB);
+  void Save(void);
+  };
+
+static cRecordingsCache RecordingsCache;
+
+cRecordingsCache::cRecordingsCache(void)
+:entriesHash(RECORDINGSCACHEHASHSIZE)
 {
-  deleted = Deleted;
-  lastUpdate = 0;
-  state = 0;
+  fileName = NULL;
+  loaded = false;
+  modified = false;
 }
 
-cRecordings::~cRecordings()
+cRecordingsCache::~cRecordingsCache()
+{
+  free(fileName);
+}
+
+void cRecordingsCache::SetFileName(const char *FileName)
+{
+  cMutexLock MutexLock(&mutex);
+  free(fileName);
+  fileName = FileName ? strdup(FileName) : NULL;
+  loaded = false;
+}
+
+unsigned int cRecordingsCache::HashKey(const char *FileName)
+{
+  unsigned int h = 0;
+  while (*FileName)
+        h = h * 31 + (unsigned char)*FileName++;
+  return h;
+}
+
+cRecordingsCacheEntry *cRecordingsCache::Find(const char *FileName)
+{
+  if (cList<cHashObject> *list = entriesHash.GetList(HashKey(FileName))) {
+     for (cHashObject *hobj = list->First(); hobj; hobj = list->Next(hobj)) {
+         cRecordingsCacheEntry *e = (cRecordingsCacheEntry *)hobj->Object();
+         if (strcmp(e->fileName, FileName) == 0)
+            return e;
+         }
+     }
+  return NULL;
+}
+
+void cRecordingsCache::Load(void)
+{
+  loaded = true;
+  entriesHash.Clear();
+  entries.Clear();
+  modified = false;
+  if (fileName) {
+     FILE *f = fopen(fileName, "r");
+     if (f) {
+        cReadLine ReadLine;
+        char *s;
+        while ((s = ReadLine.Read(f)) != NULL) {
+              long int MTime, LastUsed;
+              unsigned long int Inode;
+              int NumFrames, FileSizeMB;
+              int n = 0;
+              if (5 == sscanf(s, "%ld %lu %d %d %ld %n", &MTime, &Inode, &NumFrames, &FileSizeMB, &LastUsed, &n) && n > 0 && s[n] && !Find(s + n)) {
+                 cRecordingsCacheEntry *e = new cRecordingsCacheEntry(s + n);
+                 e->mtime = MTime;
+                 e->inode = Inode;
+                 e->numFrames = NumFrames;
+                 e->fileSizeMB = FileSizeMB;
+                 e->lastUsed = LastUsed;
+                 entries.Add(e);
+                 entriesHash.Add(e, HashKey(e->fileName));
+                 }
+              else
+                 esyslog("ERROR: invalid line in %s: %s", fileName, s);
+              }
+        fclose(f);
+        }
+     else if (errno != ENOENT)
+        LOG_ERROR_STR(fileName);
+     }
+}
+
+bool cRecordingsCache::Get(const char *FileName, const struct stat &St, int &NumFrames, int &FileSizeMB)
+{
+  cMutexLock MutexLock(&mutex);
+  if (!fileName)
+     return false;
+  if (!loaded)
+     Load();
+  cRecordingsCacheEntry *e = Find(FileName);
+  if (e && e->mtime == St.st_mtime && e->inode == St.st_ino) {
+     NumFrames = e->numFrames;
+     FileSizeMB = e->fileSizeMB;
+     time_t now = time(NULL);
+     if (now - e->lastUsed > RECORDINGSCACHEREFRESH) {
+        e->lastUsed = now;
+        modified = true;
+        }
+     return true;
+     }
+  return false;
+}
+
+void cRecordingsCache::Put(const char *FileName, const struct stat &St, int NumFrames, int FileSizeMB)
+{
+  cMutexLock MutexLock(&mutex);
+  if (!fileName)
+     return;
+  if (!loaded)
+     Load();
+  cRecordingsCacheEntry *e = Find(FileName);
+  if (!e) {
+     e = new cRecordingsCacheEntry(FileName);
+     entries.Add(e);
+     entriesHash.Add(e, HashKey(e->fileName));
+     }
+  e->mtime = St.st_mtime;
+  e->inode = St.st_ino;
+  e->numFrames = NumFrames;
+  e->fileSizeMB = FileSizeMB;
+  e->lastUsed = time(NULL);
+  modified = true;
+}
+
+void cRecordingsCache::Save(void)
+{
+  cMutexLock MutexLock(&mutex);
+  if (fileName && modified) {
+     time_t now = time(NULL);
+     cSafeFile f(fileName);
+     if (f.Open()) {
+        for (cRecordingsCacheEntry *e = entries.First(); e; ) {
+            cRecordingsCacheEntry *next = entries.Next(e);
+            if (now - e->lastUsed > RECORDINGSCACHEEXPIRE) {
+               // the recording has apparently been removed, or the video directory has changed
+               entriesHash.Del(e, HashKey(e->fileName));
+               entries.Del(e);
+               }
+            else
+               fprintf(f, "%ld %lu %d %d %ld %s\n", long(e->mtime), (unsigned long)e->inode, e->numFrames, e->fileSizeMB, long(e->lastUsed), e->fileName);
+            e = next;
+            }
+        if (f.Close())
+           modified = false;
+        }
+     else
+        LOG_ERROR_STR(fileName);
+     }
+}
+
+// --- cRecordingsWatcher ----------------------------------------------------
+
+// Instead of rescanning the whole video directory whenever the '.update' file
+// has been touched, the directories of the video directory are watched with
+// inotify, and the lists of recordings are updated according to the reported
+// changes. Watches are only set for directories that have been seen by a full
+// scan (or by the watcher itself), and only if the video directory is on a
+// local file system (changes made by other hosts on network file systems are
+// not reported by inotify). If a watch can't be set (typically because the
+// limit of /proc/sys/fs/inotify/max_user_watches has been reached), the watcher
+// gives up and the '.update' file is used again, as before.
+
+class cRecordingsWatch : public cListObject {
+public:
+  int wd;
+  bool recording;
+  cString dirName;
+  cRecordingsWatch(int Wd, bool Recording, const char *DirName) { wd = Wd; recording = Recording; dirName = DirName; }
+  };
+
+class cRecordingsWatcher : public cThread {
+private:
+  cMutex mutex;
+  int fd;
+  bool failed;
+  time_t rescanRequested;
+  cList<cRecordingsWatch> watches;
+  cHash<cRecordingsWatch> watchesHash;
+  static bool IsNetworkFileSystem(const char *DirName);
+  cRecordingsWatch *Find(int Wd);
+  void Fail(const char *Reason);
+  void Unwatch(const char *DirName);
+  void AddTree(const char *DirName, int LinkLevel = 0);
+  void DelTree(const char *DirName);
+  void HandleEvent(const struct inotify_event *Event);
+protected:
+  virtual void Action(void);
+public:
+  cRecordingsWatcher(void);
+  virtual ~cRecordingsWatcher();
+  void Watch(const char *DirName, bool Recording);
+       ///< Sets a watch on DirName, which is either a folder within the video
+       ///< directory or (if Recording is true) the directory of a recording.
+  void Shutdown(void);
+       ///< Stops watching the video directory for good. Must be called before the
+       ///< global lists of recordings are destroyed.
+  bool Watching(void) { return fd >= 0 && !failed; }
+  time_t RescanRequested(void) { return rescanRequested; }
+       ///< Returns the time at which the watcher has detected a change that
+       ///< requires a full rescan of the video directory.
+  };
+
+static cRecordingsWatcher RecordingsWatcher;
+
+cRecordingsWatcher::cRecordingsWatcher(void)
+:cThread("video directory watcher")
+{
+  fd = -1;
+  failed = false;
+  rescanRequested = 0;
+}
+
+cRecordingsWatcher::~cRecordingsWatcher()
 {
   Cancel(3);
+  if (fd >= 0)
+     close(fd);
+}
+
+bool cRecordingsWatcher::IsNetworkFileSystem(const char *DirName)
+{
+  struct statfs sfs;
+  if (statfs(DirName, &sfs) == 0) {
+     switch ((unsigned int)sfs.f_type) {
+       case 0x6969:     // NFS
+       case 0x517B:     // SMB
+       case 0xFE534D42: // SMB2
+       case 0xFF534D42: // CIFS
+            return true;
+       default: ;
+       }
+     }
+  return false;
 }
 
-void cRecordings::Action(void)
+cRecordingsWatch *cRecordingsWatcher::Find(int Wd)
 {
-  Refresh();
+  if (cList<cHashObject> *list = watchesHash.GetList(Wd)) {
+     for (cHashObject *hobj = list->First(); hobj; hobj = list->Next(hobj)) {
+         cRecordingsWatch *w = (cRecordingsWatch *)hobj->Object();
+         if (w->wd == Wd)
+            return w;
+         }
+     }
+  return NULL;
 }
 
-const char *cRecordings::UpdateFileName(void)
+void cRecordingsWatcher::Fail(const char *Reason)
 {
-  if (!updateFileName)
-     updateFileName = strdup(AddDirectory(VideoDirectory, ".update"));
-  return updateFileName;
+  if (!failed) {
+     isyslog("%s - using '.update' file to detect changes in the video directory", Reason);
+     failed = true;
+     }
 }
 
-void cRecordings::Refresh(bool Foreground)
+void cRecordingsWatcher::Shutdown(void)
 {
-  lastUpdate = time(NULL); // doing this first to make sure we don't miss anything
-  Lock();
-  Clear();
-  ChangeState();
-  Unlock();
-  ScanVideoDir(VideoDirectory, Foreground);
+  mutex.Lock();
+  failed = true; // no more new watches, and Action() ends
+  mutex.Unlock();
+  Cancel(3);
 }
 
-void cRecordings::ScanVideoDir(const char *DirName, bool Foreground, int LinkLevel)
+void cRecordingsWatcher::Watch(const char *DirName, bool Recording)
 {
+  cMutexLock MutexLock(&mutex);
+  if (failed)
+     return;
+  if (fd < 0) {
+     if (IsNetworkFileSystem(VideoDirectory)) {
+        Fail("video directory is on a network file system");
+        return;
+        }
+     fd = inotify_init();
+     if (fd < 0) {
+        LOG_ERROR;
+        Fail("can't initialize inotify");
+        return;
+        }
+     Start();
+     }
+  uint32_t Mask = Recording ? IN_CLOSE_WRITE | IN_MOVED_TO : IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+  int wd = inotify_add_watch(fd, DirName, Mask | IN_ONLYDIR);
+  if (wd >= 0) {
+     cRecordingsWatch *w = Find(wd);
+     if (!w) {
+        w = new cRecordingsWatch(wd, Recording, DirName);
+        watches.Add(w);
+        watchesHash.Add(w, wd);
+        }
+     else {
+        w->recording = Recording;
+        // The directory may have been renamed, or it may be reachable through a
+        // symbolic link, in which case its original name is kept:
+        struct stat OldSt, NewSt;
+        if (stat(w->dirName, &OldSt) != 0 || stat(DirName, &NewSt) != 0 || OldSt.st_ino != NewSt.st_ino || OldSt.st_dev != NewSt.st_dev)
+           w->dirName = DirName;
+        }
+     }
+  else if (errno == ENOSPC)
+     Fail("inotify watch limit reached");
+  else if (errno != ENOENT)
+     LOG_ERROR_STR(DirName);
+}
+
+void cRecordingsWatcher::Unwatch(const char *DirName)
+{
+  // Removes the watches of DirName and all directories below it right away, because
+  // if they have been moved, inotify keeps reporting their events under the old
+  // watch descriptors, which would then be resolved against the old names:
+  int l = strlen(DirName);
+  cMutexLock MutexLock(&mutex);
+  for (cRecordingsWatch *w = watches.First(); w; ) {
+      cRecordingsWatch *next = watches.Next(w);
+      if (strncmp(w->dirName, DirName, l) == 0 && ((*w->dirName)[l] == '/' || (*w->dirName)[l] == 0)) {
+         inotify_rm_watch(fd, w->wd);
+         watchesHash.Del(w, w->wd);
+         watches.Del(w);
+         }
+      w = next;
+      }
+}
+
+void cRecordingsWatcher::AddTree(const char *DirName, int LinkLevel)
+{
+  Watch(DirName, false);
   cReadDir d(DirName);
   struct dirent *e;
-  while ((Foreground || Running()) && (e = d.Next()) != NULL) {
+  while (Running() && (e = d.Next()) != NULL) {
+        cString buffer = AddDirectory(DirName, e->d_name);
+        struct stat st;
+        if (lstat(buffer, &st) == 0) {
+           int Link = 0;
+           if (S_ISLNK(st.st_mode)) {
+              if (LinkLevel > MAX_LINK_LEVEL)
+                 continue;
+              Link = 1;
+              if (stat(buffer, &st) != 0)
+                 continue;
+              }
+           if (S_ISDIR(st.st_mode)) {
+              if (endswith(buffer, RECEXT)) {
+                 Watch(buffer, true);
+                 Recordings.AddByName(buffer, false);
+                 }
+              else if (endswith(buffer, DELEXT))
+                 DeletedRecordings.AddByName(buffer, false);
+              else
+                 AddTree(buffer, LinkLevel + Link);
+              }
+           }
+        }
+}
+
+void cRecordingsWatcher::DelTree(const char *DirName)
+{
+  Unwatch(DirName);
+  int l = strlen(DirName);
+  cRecordings *Lists[] = { &Recordings, &DeletedRecordings };
+  for (int i = 0; i < 2; i++) {
+      cStringList FileNames;
+      {
+        cThreadLock RecordingsLock(Lists[i]);
+        for (cRecording *r = Lists[i]->First(); r; r = Lists[i]->Next(r)) {
+            if (strncmp(r->FileName(), DirName, l) == 0 && r->FileName()[l] == '/')
+               FileNames.Append(strdup(r->FileName()));
+            }
+      }
+      for (int n = 0; n < FileNames.Size(); n++)
+          Lists[i]->DelByName(FileNames[n], false);
+      }
+}
+
+void cRecordingsWatcher::HandleEvent(const struct inotify_event *Event)
+{
+  if (Event->mask & IN_Q_OVERFLOW) {
+     dsyslog("video directory watcher: event queue overflow - rescanning video directory");
+     rescanRequested = time(NULL);
+     return;
+     }
+  cString DirName;
+  bool Recording;
+  {
+    cMutexLock MutexLock(&mutex);
+    cRecordingsWatch *w = Find(Event->wd);
+    if (!w)
+       return;
+    if (Event->mask & IN_IGNORED) { // the directory has been removed
+       watchesHash.Del(w, w->wd);
+       watches.Del(w);
+       return;
+       }
+    DirName = w->dirName;
+    Recording = w->recording;
+  }
+  if (!Event->len)
+     return;
+  cString FileName = AddDirectory(DirName, Event->name);
+  if (Recording) {
+     // a recording's info file has been written:
+     if (strcmp(Event->name, INFOFILESUFFIX + 1) == 0 || strcmp(Event->name, INFOFILESUFFIX ".vdr" + 1) == 0)
+        Recordings.UpdateByName(DirName);
+     }
+  else if (Event->mask & IN_ISDIR) {
+     if (endswith(FileName, RECEXT)) {
+        if (Event->mask & (IN_CREATE | IN_MOVED_TO)) {
+           Watch(FileName, true);
+           Recordings.AddByName(FileName, false);
+           }
+        else {
+           Unwatch(FileName);
+           Recordings.DelByName(FileName, false);
+           }
+        }
+     else if (endswith(FileName, DELEXT)) {
+        if (Event->mask & (IN_CREATE | IN_MOVED_TO))
+           DeletedRecordings.AddByName(FileName, false);
+        else
+           DeletedRecordings.DelByName(FileName, false);
+        }
+     else if (Event->mask & (IN_CREATE | IN_MOVED_TO))
+        AddTree(FileName);
+     else
+        DelTree(FileName);
+     }
+}
+
+void cRecordingsWatcher::Action(void)
+{
+  char *Buffer = MALLOC(char, WATCHERBUFFERSIZE);
+  cPoller Poller(fd);
+  while (Running() && !failed) {
+        if (Poller.Poll(WATCHERPOLLTIMEOUT)) {
+           int r = read(fd, Buffer, WATCHERBUFFERSIZE);
+           if (r < 0) {
+              if (errno != EINTR && errno != EAGAIN) {
+                 LOG_ERROR;
+                 Fail("can't read inotify events");
+                 }
+              continue;
+              }
+           for (char *p = Buffer; p < Buffer + r; ) {
+               const struct inotify_event *Event = (const struct inotify_event *)p;
+               HandleEvent(Event);
+               p += sizeof(struct inotify_event) + Event->len;
+               }
+           }
+        }
+  free(Buffer);
+  // Once the watcher has failed (or is shut down) the watches are of no more use,
+  // and would only take up the user's inotify quota:
+  cMutexLock MutexLock(&mutex);
+  watchesHash.Clear();
+  watches.Clear();
+  close(fd);
+  fd = -1;
+}
+
+// --- cVideoDirScanner ------------------------------------------------------
+
+// Scanning the video directory is dominated by the latency of the file system
+// calls (especially on network file systems), not by their bandwidth. So the
+// directory tree is explored by several threads in parallel, each of which
+// takes the next directory from a common list, loads the recordings in it and
+// adds the directories it finds to that list.
+
+class cVideoDirScanner;
+
+class cVideoDirScannerThread : public cThread {
+private:
+  cVideoDirScanner *scanner;
+protected:
+  virtual void Action(void);
+public:
+  cVideoDirScannerThread(cVideoDirScanner *Scanner);
+  virtual ~cVideoDirScannerThread();
+  };
+
+class cVideoDirScanner {
+private:
+  cRecordings *recordings;
+  bool foreground;
+  cMutex mutex; // protects dirNames, linkLevels and busy
+  cCondVar dirsAvailable;
+  cStringList dirNames;
+  cVector<int> linkLevels;
+  int busy;
+  int expectedState; // the recordings' state if only this scanner has changed them
+  bool checkDuplicates; // somebody else (like the watcher) has changed the recordings
+  bool Scanning(void) { return foreground || recordings->Running(); }
+  void ScanDir(const char *DirName, int LinkLevel);
+public:
+  cVideoDirScanner(cRecordings *Recordings, bool Foreground);
+  void Scan(const char *DirName, int LinkLevel);
+       ///< Scans the tree at DirName with VIDEODIRSCANNERS threads (including
+       ///< the calling one) and returns when all of it has been scanned, or when
+       ///< the scan has been cancelled (unless it runs in the foreground).
+  void Work(void);
+  };
+
+cVideoDirScannerThread::cVideoDirScannerThread(cVideoDirScanner *Scanner)
+:cThread("video directory scanner worker")
+{
+  scanner = Scanner;
+}
+
+cVideoDirScannerThread::~cVideoDirScannerThread()
+{
+  Cancel(3);
+}
+
+void cVideoDirScannerThread::Action(void)
+{
+  scanner->Work();
+}
+
+cVideoDirScanner::cVideoDirScanner(cRecordings *Recordings, bool Foreground)
+{
+  recordings = Recordings;
+  foreground = Foreground;
+  busy = 0;
+  recordings->Lock();
+  expectedState = recordings->state;
+  checkDuplicates = recordings->Count() > 0;
+  recordings->Unlock();
+}
+
+void cVideoDirScanner::Scan(const char *DirName, int LinkLevel)
+{
+  dirNames.Append(strdup(DirName));
+  linkLevels.Append(LinkLevel);
+  cVideoDirScannerThread *Threads[VIDEODIRSCANNERS - 1];
+  for (int i = 0; i < VIDEODIRSCANNERS - 1; i++) {
+      Threads[i] = new cVideoDirScannerThread(this);
+      Threads[i]->Start();
+      }
+  Work();
+  for (int i = 0; i < VIDEODIRSCANNERS - 1; i++)
+      delete Threads[i]; // they end as soon as there is nothing left to do
+}
+
+void cVideoDirScanner::Work(void)
+{
+  cMutexLock MutexLock(&mutex);
+  for (;;) {
+      int n = dirNames.Size();
+      if (n && Scanning()) {
+         char *DirName = dirNames[n - 1];
+         int LinkLevel = linkLevels[n - 1];
+         dirNames.Remove(n - 1);
+         linkLevels.Remove(n - 1);
+         busy++;
+         mutex.Unlock();
+         ScanDir(DirName, LinkLevel);
+         free(DirName);
+         mutex.Lock();
+         busy--;
+         dirsAvailable.Broadcast();
+         }
+      else if (busy) // another thread may still find more directories
+         dirsAvailable.TimedWait(mutex, 100);
+      else
+         break;
+      }
+  dirsAvailable.Broadcast();
+}
+
+void cVideoDirScanner::ScanDir(const char *DirName, int LinkLevel)
+{
+  cReadDir d(DirName);
+  struct dirent *e;
+  while (Scanning() && (e = d.Next()) != NULL) {
         cString buffer = AddDirectory(DirName, e->d_name);
         struct stat st;
         if (lstat(buffer, &st) == 0) {
@@ -1279,28 +1857,105 @@ void cRecordings::ScanVideoDir(const char *DirName, bool Foreground, int LinkLev
                  continue;
               }
            if (S_ISDIR(st.st_mode)) {
-              if (endswith(buffer, deleted ? DELEXT : RECEXT)) {
+              if (!recordings->deleted && !endswith(buffer, DELEXT))
+                 RecordingsWatcher.Watch(buffer, endswith(buffer, RECEXT));
+              if (endswith(buffer, recordings->deleted ? DELEXT : RECEXT)) {
                  cRecording *r = new cRecording(buffer);
                  if (r->Name()) {
-                    r->NumFrames(); // initializes the numFrames member
-                    r->FileSizeMB(); // initializes the fileSizeMB member
-                    if (deleted)
+                    if (!RecordingsCache.Get(r->FileName(), st, r->numFrames, r->fileSizeMB)) {
+                       r->NumFrames(); // initializes the numFrames member
+                       r->FileSizeMB(); // initializes the fileSizeMB member
+                       if (r->numFrames >= 0 && r->fileSizeMB >= 0) // only complete recordings are cached
+                          RecordingsCache.Put(r->FileName(), st, r->numFrames, r->fileSizeMB);
+                       }
+                    if (recordings->deleted)
                        r->deleted = time(NULL);
-                    Lock();
-                    Add(r);
-                    ChangeState();
-                    Unlock();
+                    recordings->Lock();
+                    // The watcher may have added this recording in the meantime, but searching
+                    // the list is only necessary if anybody else has changed it at all:
+                    if (recordings->state != expectedState)
+                       checkDuplicates = true;
+                    if (!checkDuplicates || !recordings->GetByName(r->FileName())) {
+                       recordings->Add(r);
+                       recordings->ChangeState();
+                       expectedState = recordings->state;
+                       r = NULL;
+                       }
+                    recordings->Unlock();
                     }
-                 else
-                    delete r;
+                 delete r;
+                 }
+              else {
+                 cMutexLock MutexLock(&mutex);
+                 dirNames.Append(strdup(buffer));
+                 linkLevels.Append(LinkLevel + Link);
+                 dirsAvailable.Broadcast();
                  }
-              else
-                 ScanVideoDir(buffer, Foreground, LinkLevel + Link);
               }
            }
         }
 }
 
+// --- cRecordings -----------------------------------------------------------
+
+cRecordings Recordings;
+
+char *cRecordings::updateFileName = NULL;
+
+cRecordings::cRecordings(bool Deleted)
+:cThread("video directory scanner")
+{
+  deleted = Deleted;
+  lastUpdate = 0;
+  state = 0;
+  SetIndexed();
+}
+
+cRecordings::~cRecordings()
+{
+  // The watcher is destroyed after Recordings (but before DeletedRecordings),
+  // and it must no longer update the lists once the first of them is gone:
+  if (this == &Recordings)
+     RecordingsWatcher.Shutdown();
+  Cancel(3);
+}
+
+void cRecordings::Action(void)
+{
+  Refresh();
+}
+
+const char *cRecordings::UpdateFileName(void)
+{
+  if (!updateFileName)
+     updateFileName = strdup(AddDirectory(VideoDirectory, ".update"));
+  return updateFileName;
+}
+
+void cRecordings::Refresh(bool Foreground)
+{
+  lastUpdate = time(NULL); // doing this first to make sure we don't miss anything
+  Lock();
+  Clear();
+  ChangeState();
+  Unlock();
+  if (!deleted)
+     RecordingsWatcher.Watch(VideoDirectory, false);
+  ScanVideoDir(VideoDirectory, Foreground);
+  RecordingsCache.Save();
+}
+
+void cRecordings::SetCacheFileName(const char *FileName)
+{
+  RecordingsCache.SetFileName(FileName);
+}
+
+void cRecordings::ScanVideoDir(const char *DirName, bool Foreground, int LinkLevel)
+{
+  cVideoDirScanner VideoDirScanner(this, Foreground);
+  VideoDirScanner.Scan(DirName, LinkLevel);
+}
+
 bool cRecordings::StateChanged(int &State)
 {
   int NewState = state;
@@ -1319,6 +1974,8 @@ void cRecordings::TouchUpdate(void)
 
 bool cRecordings::NeedsUpdate(void)
 {
+  if (RecordingsWatcher.Watching())
+     return lastUpdate < RecordingsWatcher.RescanRequested();
   time_t lastModified = LastModifiedTime(UpdateFileName());
   if (lastModified > time(NULL))
      return false; // somebody's clock isn't running correctly
@@ -1353,6 +2010,8 @@ void cRecordings::AddByName(const char *FileName, bool TriggerUpdate)
   cRecording *recording = GetByName(FileName);
   if (!recording) {
      recording = new cRecording(FileName);
+     if (deleted)
+        recording->deleted = time(NULL);
      Add(recording);
      ChangeState();
      if (TriggerUpdate)
@@ -1360,7 +2019,7 @@ void cRecordings::AddByName(const char *FileName, bool TriggerUpdate)
      }
 }
 
-void cRecordings::DelByName(const char *FileName)
+void cRecordings::DelByName(const char *FileName, bool TriggerUpdate)
 {
   LOCK_THREAD;
   cRecording *recording = GetByName(FileName);
@@ -1378,7 +2037,8 @@ void cRecordings::DelByName(const char *FileName)
         }
      delete recording;
      ChangeState();
-     TouchUpdate();
+     if (TriggerUpdate)
+        TouchUpdate();
      }
 }
 
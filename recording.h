@@ -80,6 +80,7 @@ public:
 
 class cRecording : public cListObject {
   friend class cRecordings;
+  friend class cVideoDirScanner;
 private:
   mutable int resume;
   mutable char *titleBuffer;
@@ -157,6 +158,7 @@ public:
   };
 
 class cRecordings : public cList<cRecording>, public cThread {
+  friend class cVideoDirScanner;
 private:
   static char *updateFileName;
   bool deleted;
@@ -170,6 +172,11 @@ protected:
 public:
   cRecordings(bool Deleted = false);
   virtual ~cRecordings();
+  static void SetCacheFileName(const char *FileName);
+       ///< Sets the name of the file that caches the number of frames and the
+       ///< file size of complete recordings, so that these don't have to be
+       ///< determined again for every recording when the video directory is
+       ///< scanned. Without a file name (the default), nothing is cached.
   bool Load(void) { return Update(true); }
        ///< Loads the current list of recordings and returns true if there
        ///< is anything in it (for compatibility with older plugins - use
@@ -185,13 +192,18 @@ public:
        ///< instances of VDR that access the same video directory can be triggered
        ///< to update their recordings list.
   bool NeedsUpdate(void);
+       ///< Returns true if the list of recordings needs to be updated because
+       ///< the '.update' file has been touched. If the video directory is
+       ///< watched with inotify, changes are applied to the list as they happen,
+       ///< and a full update is only necessary if the watcher couldn't handle
+       ///< a change by itself.
   void ChangeState(void) { state++; }
   bool StateChanged(int &State);
   void ResetResume(const char *ResumeFileName = NULL);
   void ClearSortNames(void);
   cRecording *GetByName(const char *FileName);
   void AddByName(const char *FileName, bool TriggerUpdate = true);
-  void DelByName(const char *FileName);
+  void DelByName(const char *FileName, bool TriggerUpdate = true);
   void UpdateByName(const char *FileName);
   int TotalFileSizeMB(void);
   double MBperMinute(void);
@@ -13,6 +13,19 @@
 #include "device.h"
 #include "thread.h"
 
+#define MAXSECTIONSPERREAD      32 // max. number of sections read from one filter handle in one go
+#define MAXQUEUEDSECTIONS     1000 // max. number of sections waiting for a queued filter
+#define SECTIONWORKERS           2 // number of threads processing the sections of queued filters
+#define SECTIONSTATSINTERVAL  3600 // seconds between logging the filter statistics
+
+static uint64_t NowUs(void)
+{
+  struct timespec tp;
+  if (clock_gettime(CLOCK_MONOTONIC, &tp) == 0)
+     return uint64_t(tp.tv_sec) * 1000000 + tp.tv_nsec / 1000;
+  return 0;
+}
+
 // --- cFilterHandle----------------------------------------------------------
 
 class cFilterHandle : public cListObject {
@@ -30,13 +43,144 @@ cFilterHandle::cFilterHandle(const cFilterData &FilterData)
   used = 0;
 }
 
+// --- cSection --------------------------------------------------------------
+
+class cSection : public cListObject {
+public:
+  u_short pid;
+  u_char tid;
+  int length;
+  u_char *data;
+  cSection(u_short Pid, u_char Tid, const u_char *Data, int Length);
+  virtual ~cSection();
+  };
+
+cSection::cSection(u_short Pid, u_char Tid, const u_char *Data, int Length)
+{
+  pid = Pid;
+  tid = Tid;
+  length = Length;
+  data = MALLOC(u_char, Length);
+  memcpy(data, Data, Length);
+}
+
+cSection::~cSection()
+{
+  free(data);
+}
+
+// --- cSectionQueue ---------------------------------------------------------
+
+// Every attached filter has a cSectionQueue, which holds the sections waiting
+// to be processed (only in case of a queued filter) as well as the statistics
+// about the time the filter's Process() function takes.
+
+class cSectionQueue : public cListObject {
+public:
+  cFilter *filter;
+  cList<cSection> sections;
+  tThreadId busy; // the worker thread that is currently processing a section of this queue
+  bool detached;
+  int processed;
+  int dropped;
+  uint64_t totalUs;
+  int maxUs;
+  cSectionQueue(cFilter *Filter);
+  };
+
+cSectionQueue::cSectionQueue(cFilter *Filter)
+{
+  filter = Filter;
+  busy = 0;
+  detached = false;
+  processed = 0;
+  dropped = 0;
+  totalUs = 0;
+  maxUs = 0;
+}
+
+// --- cSectionWorker --------------------------------------------------------
+
+class cSectionWorker : public cThread {
+private:
+  cSectionHandler *sectionHandler;
+protected:
+  virtual void Action(void);
+public:
+  cSectionWorker(cSectionHandler *SectionHandler);
+  virtual ~cSectionWorker();
+  };
+
 // --- cSectionHandlerPrivate ------------------------------------------------
 
 class cSectionHandlerPrivate {
 public:
   cChannel channel;
+  cMutex mutex; // protects the queues
+  cCondVar queueReady;
+  cCondVar queueIdle;
+  cList<cSectionQueue> queues;
+  cSectionWorker *workers[SECTIONWORKERS];
+  time_t lastReport;
+  cSectionHandlerPrivate(void);
+  bool Busy(void);
   };
 
+cSectionHandlerPrivate::cSectionHandlerPrivate(void)
+{
+  memset(workers, 0, sizeof(workers));
+  lastReport = time(NULL);
+}
+
+bool cSectionHandlerPrivate::Busy(void)
+{
+  tThreadId ThreadId = cThread::ThreadId();
+  for (cSectionQueue *q = queues.First(); q; q = queues.Next(q)) {
+      if (q->busy && q->busy != ThreadId) // a filter may do things that cause a flush from within its own Process() function
+         return true;
+      }
+  return false;
+}
+
+// --- cSectionWorker --------------------------------------------------------
+
+cSectionWorker::cSectionWorker(cSectionHandler *SectionHandler)
+:cThread("section worker", true)
+{
+  sectionHandler = SectionHandler;
+}
+
+cSectionWorker::~cSectionWorker()
+{
+  Cancel(3);
+}
+
+void cSectionWorker::Action(void)
+{
+  cSectionHandlerPrivate *shp = sectionHandler->shp;
+  cMutexLock MutexLock(&shp->mutex);
+  while (Running()) {
+        cSectionQueue *q = shp->queues.First();
+        while (q && (q->busy || !q->sections.First()))
+              q = shp->queues.Next(q);
+        if (!q) {
+           shp->queueReady.TimedWait(shp->mutex, 1000);
+           continue;
+           }
+        cSection *Section = q->sections.First();
+        q->sections.Del(Section, false);
+        q->busy = ThreadId();
+        shp->mutex.Unlock();
+        sectionHandler->Process(q, Section->pid, Section->tid, Section->data, Section->length);
+        delete Section;
+        shp->mutex.Lock();
+        q->busy = 0;
+        if (q->detached)
+           shp->queues.Del(q);
+        shp->queueIdle.Broadcast();
+        }
+}
+
 // --- cSectionHandler -------------------------------------------------------
 
 cSectionHandler::cSectionHandler(cDevice *Device)
@@ -54,6 +198,9 @@ cSectionHandler::cSectionHandler(cDevice *Device)
 cSectionHandler::~cSectionHandler()
 {
   Cancel(3);
+  shp->queueReady.Broadcast();
+  for (int i = 0; i < SECTIONWORKERS; i++)
+      delete shp->workers[i];
   cFilter *fi;
   while ((fi = filters.First()) != NULL)
         Detach(fi);
@@ -120,6 +267,15 @@ void cSectionHandler::Attach(cFilter *Filter)
   statusCount++;
   filters.Add(Filter);
   Filter->sectionHandler = this;
+  shp->mutex.Lock();
+  shp->queues.Add(Filter->queue = new cSectionQueue(Filter));
+  shp->mutex.Unlock();
+  if (Filter->queued && !shp->workers[0]) {
+     for (int i = 0; i < SECTIONWORKERS; i++) {
+         shp->workers[i] = new cSectionWorker(this);
+         shp->workers[i]->Start();
+         }
+     }
   if (on)
      Filter->SetStatus(true);
   Unlock();
@@ -127,6 +283,19 @@ void cSectionHandler::Attach(cFilter *Filter)
 
 void cSectionHandler::Detach(cFilter *Filter)
 {
+  shp->mutex.Lock();
+  if (cSectionQueue *q = Filter->queue) {
+     // Make sure the filter's Process() function is no longer called once it is detached:
+     q->sections.Clear();
+     while (q->busy && q->busy != ThreadId())
+           shp->queueIdle.Wait(shp->mutex);
+     if (q->busy)
+        q->detached = true; // we're called from the filter's own Process() function, so the worker deletes the queue
+     else
+        shp->queues.Del(q);
+     Filter->queue = NULL;
+     }
+  shp->mutex.Unlock();
   Lock();
   statusCount++;
   Filter->SetStatus(false);
@@ -160,6 +329,71 @@ void cSectionHandler::SetStatus(bool On)
         waitForLock = On;
      }
   Unlock();
+  if (!On)
+     FlushQueues();
+}
+
+void cSectionHandler::FlushQueues(void)
+{
+  // Sections that are still waiting in the queues belong to the previous
+  // transponder, and any section that is currently being processed must be
+  // finished before a new channel is set:
+  cMutexLock MutexLock(&shp->mutex);
+  for (cSectionQueue *q = shp->queues.First(); q; q = shp->queues.Next(q))
+      q->sections.Clear();
+  while (shp->Busy())
+        shp->queueIdle.Wait(shp->mutex);
+}
+
+void cSectionHandler::Process(cSectionQueue *Queue, u_short Pid, u_char Tid, const u_char *Data, int Length)
+{
+  uint64_t Start = NowUs();
+  Queue->filter->Process(Pid, Tid, Data, Length);
+  int t = int(NowUs() - Start);
+  cMutexLock MutexLock(&shp->mutex); // ReportStatistics() may be running in a different thread
+  Queue->processed++;
+  Queue->totalUs += t;
+  if (t > Queue->maxUs)
+     Queue->maxUs = t;
+}
+
+void cSectionHandler::Distribute(u_short Pid, u_char Tid, const u_char *Data, int Length)
+{
+  // Distribute data to all attached filters:
+  bool Queued = false;
+  for (cFilter *fi = filters.First(); fi; fi = filters.Next(fi)) {
+      if (fi->Matches(Pid, Tid) && fi->queue) {
+         if (fi->queued) {
+            cMutexLock MutexLock(&shp->mutex);
+            cSectionQueue *q = fi->queue;
+            if (q->sections.Count() < MAXQUEUEDSECTIONS) {
+               q->sections.Add(new cSection(Pid, Tid, Data, Length));
+               Queued = true;
+               }
+            else
+               q->dropped++;
+            }
+         else
+            Process(fi->queue, Pid, Tid, Data, Length);
+         }
+      }
+  if (Queued)
+     shp->queueReady.Broadcast();
+}
+
+void cSectionHandler::ReportStatistics(void)
+{
+  cMutexLock MutexLock(&shp->mutex);
+  for (cSectionQueue *q = shp->queues.First(); q; q = shp->queues.Next(q)) {
+      if (q->processed || q->dropped) {
+         cFilterData *fd = q->filter->data.First();
+         dsyslog("device %d filter %04X/%02X%s: %d sections, %d dropped, %d us average, %d us max", device->CardIndex() + 1, fd ? fd->pid : 0, fd ? fd->tid : 0, q->filter->queued ? " (queued)" : "", q->processed, q->dropped, int(q->totalUs / max(q->processed, 1)), q->maxUs);
+         q->processed = q->dropped = 0;
+         q->totalUs = 0;
+         q->maxUs = 0;
+         }
+      }
+  shp->lastReport = time(NULL);
 }
 
 void cSectionHandler::Action(void)
@@ -180,6 +414,9 @@ void cSectionHandler::Action(void)
         int oldStatusCount = statusCount;
         Unlock();
 
+        if (time(NULL) - shp->lastReport > SECTIONSTATSINTERVAL)
+           ReportStatistics();
+
         if (poll(pfd, NumFilters, 1000) > 0) {
            bool DeviceHasLock = device->HasLock();
            if (!DeviceHasLock)
@@ -195,27 +432,31 @@ void cSectionHandler::Action(void)
                          break;
                       }
                   if (fh) {
-                     // Read section data:
-                     unsigned char buf[4096]; // max. allowed size for any EIT section
-                     int r = device->ReadFilter(fh->handle, buf, sizeof(buf));
-                     if (!DeviceHasLock)
-                        continue; // we do the read anyway, to flush any data that might have come from a different transponder
-                     if (r > 3) { // minimum number of bytes necessary to get section length
-                        int len = (((buf[1] & 0x0F) << 8) | (buf[2] & 0xFF)) + 3;
-                        if (len == r) {
-                           // Distribute data to all attached filters:
-                           int pid = fh->filterData.pid;
-                           int tid = buf[0];
-                           for (cFilter *fi = filters.First(); fi; fi = filters.Next(fi)) {
-                               if (fi->Matches(pid, tid))
-                                  fi->Process(pid, tid, buf, len);
+                     // Read all section data that is currently available from this handle
+                     // (a device's filter handles aren't necessarily non-blocking, so we
+                     // make sure there actually is more data before reading again):
+                     for (int n = 0; n < MAXSECTIONSPERREAD && statusCount == oldStatusCount; n++) {
+                         if (n > 0) {
+                            pollfd p = { fh->handle, POLLIN, 0 };
+                            if (poll(&p, 1, 0) <= 0 || !(p.revents & POLLIN))
+                               break;
+                            }
+                         unsigned char buf[4096]; // max. allowed size for any EIT section
+                         int r = device->ReadFilter(fh->handle, buf, sizeof(buf));
+                         if (r <= 0)
+                            break;
+                         if (!DeviceHasLock)
+                            continue; // we do the read anyway, to flush any data that might have come from a different transponder
+                         if (r > 3) { // minimum number of bytes necessary to get section length
+                            int len = (((buf[1] & 0x0F) << 8) | (buf[2] & 0xFF)) + 3;
+                            if (len == r)
+                               Distribute(fh->filterData.pid, buf[0], buf, len);
+                            else if (time(NULL) - lastIncompleteSection > 10) { // log them only every 10 seconds
+                               dsyslog("read incomplete section - len = %d, r = %d", len, r);
+                               lastIncompleteSection = time(NULL);
                                }
-                           }
-                        else if (time(NULL) - lastIncompleteSection > 10) { // log them only every 10 seconds
-                           dsyslog("read incomplete section - len = %d, r = %d", len, r);
-                           lastIncompleteSection = time(NULL);
-                           }
-                        }
+                            }
+                         }
                      }
                   }
                }
@@ -19,9 +19,11 @@ class cDevice;
 class cChannel;
 class cFilterHandle;
 class cSectionHandlerPrivate;
+class cSectionQueue;
 
 class cSectionHandler : public cThread {
   friend class cFilter;
+  friend class cSectionWorker;
 private:
   cSectionHandlerPrivate *shp;
   cDevice *device;
@@ -32,6 +34,10 @@ private:
   cList<cFilterHandle> filterHandles;
   void Add(const cFilterData *FilterData);
   void Del(const cFilterData *FilterData);
+  void Distribute(u_short Pid, u_char Tid, const u_char *Data, int Length);
+  void Process(cSectionQueue *Queue, u_short Pid, u_char Tid, const u_char *Data, int Length);
+  void FlushQueues(void);
+  void ReportStatistics(void);
   virtual void Action(void);
 public:
   cSectionHandler(cDevice *Device);
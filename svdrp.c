@@ -308,8 +308,9 @@ const char *HelpPages[] = {
   "SCAN\n"
   "    Forces an EPG scan. If this is a single DVB device system, the scan\n"
   "    will be done on the primary device unless it is currently recording.",
-  "STAT disk\n"
-  "    Return information about disk usage (total, free, percent).",
+  "STAT disk | epg\n"
+  "    Return information about disk usage (total, free, percent), or about\n"
+  "    the memory used by the EPG data.",
   "UPDT <settings>\n"
   "    Updates a timer. Settings must be in the same format as returned\n"
   "    by the LSTT command. If a timer with the same channel, day, start\n"
@@ -1553,6 +1554,8 @@ void cSVDRP::CmdSTAT(const char *Option)
         int Percent = VideoDiskSpace(&FreeMB, &UsedMB);
         Reply(250, "%dMB %dMB %d%%", FreeMB + UsedMB, FreeMB, Percent);
         }
+     else if (strcasecmp(Option, "EPG") == 0)
+        Reply(250, "%s", *EpgMemoryStatistics());
      else
         Reply(501, "Invalid Option \"%s\"", Option);
      }
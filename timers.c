@@ -153,6 +153,7 @@ cTimer& cTimer::operator= (const cTimer &Timer)
      free(aux);
      aux = Timer.aux ? strdup(Timer.aux) : NULL;
      event = NULL;
+     Timers.Invalidate();
      }
   return *this;
 }
@@ -335,6 +336,7 @@ bool cTimer::Parse(const char *s)
   free(daybuffer);
   free(filebuffer);
   free(s2);
+  Timers.Invalidate();
   return result;
 }
 
@@ -607,26 +609,31 @@ void cTimer::SetInVpsMargin(bool InVpsMargin)
 void cTimer::SetDay(time_t Day)
 {
   day = Day;
+  Timers.Invalidate();
 }
 
 void cTimer::SetWeekDays(int WeekDays)
 {
   weekdays = WeekDays;
+  Timers.Invalidate();
 }
 
 void cTimer::SetStart(int Start)
 {
   start = Start;
+  Timers.Invalidate();
 }
 
 void cTimer::SetStop(int Stop)
 {
   stop = Stop;
+  Timers.Invalidate();
 }
 
 void cTimer::SetPriority(int Priority)
 {
   priority = Priority;
+  Timers.Invalidate();
 }
 
 void cTimer::SetLifetime(int Lifetime)
@@ -643,21 +650,28 @@ void cTimer::SetAux(const char *Aux)
 void cTimer::SetDeferred(int Seconds)
 {
   deferred = time(NULL) + Seconds;
+  Timers.Invalidate();
   isyslog("timer %s deferred for %d seconds", *ToDescr(), Seconds);
 }
 
 void cTimer::SetFlags(uint Flags)
 {
+  if (~flags & Flags & (tfActive | tfVps))
+     Timers.Invalidate();
   flags |= Flags;
 }
 
 void cTimer::ClrFlags(uint Flags)
 {
+  if (flags & Flags & (tfActive | tfVps))
+     Timers.Invalidate();
   flags &= ~Flags;
 }
 
 void cTimer::InvFlags(uint Flags)
 {
+  if (Flags & (tfActive | tfVps))
+     Timers.Invalidate();
   flags ^= Flags;
 }
 
@@ -670,6 +684,7 @@ void cTimer::Skip(void)
 {
   day = IncDay(SetTime(StartTime(), 0), 1);
   startTime = 0;
+  Timers.Invalidate();
   SetEvent(NULL);
 }
 
@@ -680,6 +695,7 @@ void cTimer::OnOff(void)
   else if (day) {
      day = 0;
      ClrFlags(tfActive);
+     Timers.Invalidate();
      }
   else if (HasFlags(tfActive))
      Skip();
@@ -689,6 +705,340 @@ void cTimer::OnOff(void)
   Matches(); // refresh start and end time
 }
 
+// --- cTimerMatchIndex ------------------------------------------------------
+
+// An event can only be matched by a timer on its own channel, and only by a
+// repeating timer or a single shot timer that overlaps the event (or starts
+// at its VPS time). The index holds the timers sorted by channel, together
+// with the start and stop time of the single shot ones, so that GetMatch()
+// needs to call cTimer::Matches() only for these candidates.
+
+struct tTimerMatchEntry {
+  const cChannel *channel;
+  int position; // the timer's position in the list, to keep the list's order among the timers of a channel
+  time_t start; // 0 for repeating timers
+  time_t stop;
+  cTimer *timer;
+  };
+
+class cTimerMatchIndex {
+private:
+  tTimerMatchEntry *entries;
+  int numEntries;
+  static int CompareEntries(const void *a, const void *b);
+public:
+  cTimerMatchIndex(void);
+  ~cTimerMatchIndex();
+  void Build(cTimers *Timers);
+  cTimer *GetMatch(const cEvent *Event, eTimerMatch *Match);
+  };
+
+cTimerMatchIndex::cTimerMatchIndex(void)
+{
+  entries = NULL;
+  numEntries = 0;
+}
+
+cTimerMatchIndex::~cTimerMatchIndex()
+{
+  free(entries);
+}
+
+int cTimerMatchIndex::CompareEntries(const void *a, const void *b)
+{
+  const tTimerMatchEntry *ea = (const tTimerMatchEntry *)a;
+  const tTimerMatchEntry *eb = (const tTimerMatchEntry *)b;
+  if (ea->channel != eb->channel)
+     return ea->channel < eb->channel ? -1 : 1;
+  return ea->position - eb->position;
+}
+
+void cTimerMatchIndex::Build(cTimers *Timers)
+{
+  free(entries);
+  numEntries = 0;
+  entries = MALLOC(tTimerMatchEntry, max(Timers->Count(), 1));
+  for (cTimer *ti = Timers->First(); ti; ti = Timers->Next(ti)) {
+      tTimerMatchEntry *e = &entries[numEntries];
+      e->channel = ti->Channel();
+      e->position = numEntries++;
+      e->timer = ti;
+      e->start = e->stop = 0;
+      if (ti->IsSingleEvent()) {
+         int begin  = cTimer::TimeToInt(ti->Start());
+         int length = cTimer::TimeToInt(ti->Stop()) - begin;
+         if (length < 0)
+            length += SECSINDAY;
+         e->start = cTimer::SetTime(ti->Day(), begin);
+         e->stop = e->start + length;
+         }
+      }
+  qsort(entries, numEntries, sizeof(tTimerMatchEntry), CompareEntries);
+}
+
+cTimer *cTimerMatchIndex::GetMatch(const cEvent *Event, eTimerMatch *Match)
+{
+  cTimer *t = NULL;
+  eTimerMatch m = tmNone;
+  if (const cChannel *Channel = Channels.GetByChannelID(Event->ChannelID())) {
+     // find the first entry of this channel:
+     int lo = 0;
+     int hi = numEntries;
+     while (lo < hi) {
+           int mid = (lo + hi) / 2;
+           if (entries[mid].channel < Channel)
+              lo = mid + 1;
+           else
+              hi = mid;
+           }
+     for (int i = lo; i < numEntries && entries[i].channel == Channel; i++) {
+         tTimerMatchEntry *e = &entries[i];
+         if (e->start && !(e->start <= Event->EndTime() && Event->StartTime() <= e->stop) && !(Event->Vps() && e->start == Event->Vps()))
+            continue;
+         eTimerMatch tm = e->timer->Matches(Event);
+         if (tm > m) {
+            t = e->timer;
+            m = tm;
+            if (m == tmFull)
+               break;
+            }
+         }
+     }
+  if (Match)
+     *Match = m;
+  return t;
+}
+
+// --- cTimerHeap ------------------------------------------------------------
+
+struct tTimerSchedule {
+  time_t time;
+  int priority; // higher priorities come first at the same time (see cTimer::Compare())
+  int position; // the timer's position in the list
+  cTimer *timer;
+  };
+
+class cTimerHeap {
+private:
+  tTimerSchedule *entries;
+  int size;
+  int allocated;
+  static bool Less(const tTimerSchedule &a, const tTimerSchedule &b) { return a.time < b.time || (a.time == b.time && a.priority > b.priority); }
+public:
+  cTimerHeap(void) { entries = NULL; size = allocated = 0; }
+  ~cTimerHeap() { free(entries); }
+  int Size(void) const { return size; }
+  const tTimerSchedule &Top(void) const { return entries[0]; }
+  void Clear(void) { size = 0; }
+  void Push(time_t Time, int Priority, int Position, cTimer *Timer);
+  void Pop(void);
+  };
+
+void cTimerHeap::Push(time_t Time, int Priority, int Position, cTimer *Timer)
+{
+  if (size >= allocated) {
+     allocated = max(allocated * 2, 16);
+     entries = (tTimerSchedule *)realloc(entries, allocated * sizeof(tTimerSchedule));
+     }
+  int i = size++;
+  while (i > 0) {
+        int Parent = (i - 1) / 2;
+        tTimerSchedule &p = entries[Parent];
+        if (!(Time < p.time || (Time == p.time && Priority > p.priority)))
+           break;
+        entries[i] = p;
+        i = Parent;
+        }
+  entries[i].time = Time;
+  entries[i].priority = Priority;
+  entries[i].position = Position;
+  entries[i].timer = Timer;
+}
+
+void cTimerHeap::Pop(void)
+{
+  if (--size > 0) {
+     tTimerSchedule Last = entries[size];
+     int i = 0;
+     for (;;) {
+         int Child = 2 * i + 1;
+         if (Child >= size)
+            break;
+         if (Child + 1 < size && Less(entries[Child + 1], entries[Child]))
+            Child++;
+         if (!Less(entries[Child], Last))
+            break;
+         entries[i] = entries[Child];
+         i = Child;
+         }
+     entries[i] = Last;
+     }
+}
+
+// --- cTimerSchedule --------------------------------------------------------
+
+// The main loop checks every few seconds which timer shall start recording,
+// and the shutdown handler asks for the next timer to wake up for. Instead of
+// calling cTimer::Matches() on all timers for this, the timers are kept in
+// priority queues ordered by the time at which they become due, or at which
+// they start, respectively. The times of VPS timers depend on their events,
+// which may change at any time, so these are always looked at. Timers that
+// are inactive are dropped from the queues. Any modification of the list of
+// timers causes the queues to be rebuilt.
+
+class cTimerSchedule {
+private:
+  cTimerHeap waiting;    // timers that are not due before the given time
+  cVector<tTimerSchedule *> due; // timers that are checked at every call to GetMatch(), sorted by position
+  cTimerHeap upcoming;   // active timers by start time, for GetNextActiveTimer()
+  cVector<cTimer *> vpsTimers;
+  int lastPending;
+  cTimers *timers;
+  time_t lastTime;       // the queues only hold for times that don't go backwards
+  void AddDue(const tTimerSchedule &Entry);
+  void CheckTime(time_t t);
+public:
+  cTimerSchedule(void);
+  ~cTimerSchedule();
+  void Build(cTimers *Timers);
+  cTimer *GetMatch(time_t t);
+  cTimer *GetNextActiveTimer(void);
+  };
+
+cTimerSchedule::cTimerSchedule(void)
+{
+  lastPending = -1;
+  timers = NULL;
+  lastTime = 0;
+}
+
+cTimerSchedule::~cTimerSchedule()
+{
+  for (int i = 0; i < due.Size(); i++)
+      delete due[i];
+}
+
+void cTimerSchedule::AddDue(const tTimerSchedule &Entry)
+{
+  int i = due.Size();
+  while (i > 0 && due[i - 1]->position > Entry.position)
+        i--;
+  due.Insert(new tTimerSchedule(Entry), i);
+}
+
+void cTimerSchedule::CheckTime(time_t t)
+{
+  if (t < lastTime && timers) {
+     // The system time has been set back, so timers that have already been
+     // dropped from the queues may be due (again):
+     dsyslog("time has gone back by %d seconds - rebuilding timer schedule", int(lastTime - t));
+     Build(timers);
+     }
+  lastTime = t;
+}
+
+void cTimerSchedule::Build(cTimers *Timers)
+{
+  for (int i = 0; i < due.Size(); i++)
+      delete due[i];
+  due.Clear();
+  waiting.Clear();
+  upcoming.Clear();
+  vpsTimers.Clear();
+  timers = Timers;
+  lastTime = 0;
+  int Position = 0;
+  for (cTimer *ti = Timers->First(); ti; ti = Timers->Next(ti)) {
+      tTimerSchedule e = { 0, ti->Priority(), Position++, ti };
+      due.Append(new tTimerSchedule(e)); // GetMatch() will put it where it belongs
+      if (ti->HasFlags(tfVps))
+         vpsTimers.Append(ti);
+      else if (ti->HasFlags(tfActive)) {
+         ti->Matches();
+         upcoming.Push(ti->StartTime(), e.priority, e.position, ti);
+         }
+      }
+  lastPending = -1;
+}
+
+cTimer *cTimerSchedule::GetMatch(time_t t)
+{
+  CheckTime(t);
+  while (waiting.Size() && waiting.Top().time <= t) {
+        AddDue(waiting.Top());
+        waiting.Pop();
+        }
+  tTimerSchedule *t0 = NULL;
+  for (int i = 0; i < due.Size(); i++) {
+      tTimerSchedule *e = due[i];
+      cTimer *ti = e->timer;
+      if (ti->Recording())
+         continue;
+      if (ti->Matches(t)) {
+         if (ti->Pending()) {
+            if (e->position > lastPending) {
+               lastPending = e->position;
+               return ti;
+               }
+            else
+               continue;
+            }
+         if (!t0 || ti->Priority() > t0->timer->Priority())
+            t0 = e;
+         }
+      else if (!ti->HasFlags(tfVps)) {
+         if (!ti->HasFlags(tfActive)) {
+            // will be looked at again when the timers are modified
+            due.Remove(i--);
+            delete e;
+            }
+         else {
+            time_t Next = max(ti->StartTime(), ti->Deferred());
+            if (Next > t) {
+               due.Remove(i--);
+               waiting.Push(Next, e->priority, e->position, ti);
+               delete e;
+               }
+            }
+         }
+      }
+  if (!t0)
+     lastPending = -1;
+  return t0 ? t0->timer : NULL;
+}
+
+cTimer *cTimerSchedule::GetNextActiveTimer(void)
+{
+  time_t now = time(NULL);
+  CheckTime(now);
+  cTimer *t0 = NULL;
+  for (int i = 0; i < vpsTimers.Size(); i++) {
+      cTimer *ti = vpsTimers[i];
+      ti->Matches();
+      if (ti->HasFlags(tfActive) && ti->StopTime() > now && (!t0 || ti->Compare(*t0) < 0))
+         t0 = ti;
+      }
+  while (upcoming.Size()) {
+        tTimerSchedule e = upcoming.Top();
+        cTimer *ti = e.timer;
+        ti->Matches();
+        if (!ti->HasFlags(tfActive) || ti->StopTime() <= now) {
+           upcoming.Pop(); // it's over
+           continue;
+           }
+        if (ti->StartTime() != e.time) {
+           // a repeating timer has moved on to its next occurrence
+           upcoming.Pop();
+           upcoming.Push(ti->StartTime(), e.priority, e.position, ti);
+           continue;
+           }
+        if (!t0 || ti->Compare(*t0) < 0)
+           t0 = ti;
+        break;
+        }
+  return t0;
+}
+
 // --- cTimers ---------------------------------------------------------------
 
 cTimers Timers;
@@ -699,6 +1049,32 @@ cTimers::cTimers(void)
   beingEdited = 0;;
   lastSetEvents = 0;
   lastDeleteExpired = 0;
+  matchIndex = new cTimerMatchIndex;
+  schedule = new cTimerSchedule;
+  indexesValid = false;
+  SetIndexed();
+}
+
+cTimers::~cTimers()
+{
+  delete matchIndex;
+  delete schedule;
+}
+
+void cTimers::Invalidate(void)
+{
+  cMutexLock MutexLock(&indexesMutex);
+  indexesValid = false;
+}
+
+void cTimers::BuildIndexes(void)
+{
+  // indexesMutex must be locked!
+  if (!indexesValid) {
+     matchIndex->Build(this);
+     schedule->Build(this);
+     indexesValid = true;
+     }
 }
 
 cTimer *cTimers::GetTimer(cTimer *Timer)
@@ -715,71 +1091,43 @@ cTimer *cTimers::GetTimer(cTimer *Timer)
 
 cTimer *cTimers::GetMatch(time_t t)
 {
-  static int LastPending = -1;
-  cTimer *t0 = NULL;
-  for (cTimer *ti = First(); ti; ti = Next(ti)) {
-      if (!ti->Recording() && ti->Matches(t)) {
-         if (ti->Pending()) {
-            if (ti->Index() > LastPending) {
-               LastPending = ti->Index();
-               return ti;
-               }
-            else
-               continue;
-            }
-         if (!t0 || ti->Priority() > t0->Priority())
-            t0 = ti;
-         }
-      }
-  if (!t0)
-     LastPending = -1;
-  return t0;
+  cMutexLock MutexLock(&indexesMutex);
+  BuildIndexes();
+  return schedule->GetMatch(t);
 }
 
 cTimer *cTimers::GetMatch(const cEvent *Event, eTimerMatch *Match)
 {
-  cTimer *t = NULL;
-  eTimerMatch m = tmNone;
-  for (cTimer *ti = First(); ti; ti = Next(ti)) {
-      eTimerMatch tm = ti->Matches(Event);
-      if (tm > m) {
-         t = ti;
-         m = tm;
-         if (m == tmFull)
-            break;
-         }
-      }
-  if (Match)
-     *Match = m;
-  return t;
+  cMutexLock MutexLock(&indexesMutex);
+  BuildIndexes();
+  return matchIndex->GetMatch(Event, Match);
 }
 
 cTimer *cTimers::GetNextActiveTimer(void)
 {
-  cTimer *t0 = NULL;
-  for (cTimer *ti = First(); ti; ti = Next(ti)) {
-      ti->Matches();
-      if ((ti->HasFlags(tfActive)) && (!t0 || ti->StopTime() > time(NULL) && ti->Compare(*t0) < 0))
-         t0 = ti;
-      }
-  return t0;
+  cMutexLock MutexLock(&indexesMutex);
+  BuildIndexes();
+  return schedule->GetNextActiveTimer();
 }
 
 void cTimers::SetModified(void)
 {
   cStatus::MsgTimerChange(NULL, tcMod);
   state++;
+  Invalidate();
 }
 
 void cTimers::Add(cTimer *Timer, cTimer *After)
 {
   cConfig<cTimer>::Add(Timer, After);
+  Invalidate();
   cStatus::MsgTimerChange(Timer, tcAdd);
 }
 
 void cTimers::Ins(cTimer *Timer, cTimer *Before)
 {
   cConfig<cTimer>::Ins(Timer, Before);
+  Invalidate();
   cStatus::MsgTimerChange(Timer, tcAdd);
 }
 
@@ -787,6 +1135,7 @@ void cTimers::Del(cTimer *Timer, bool DeleteObject)
 {
   cStatus::MsgTimerChange(Timer, tcDel);
   cConfig<cTimer>::Del(Timer, DeleteObject);
+  Invalidate();
 }
 
 bool cTimers::Modified(int &State)
@@ -106,18 +106,39 @@ public:
   static cString PrintDay(time_t Day, int WeekDays, bool SingleByteChars);
   };
 
+class cTimerMatchIndex;
+class cTimerSchedule;
+
 class cTimers : public cConfig<cTimer> {
+  friend class cTimer;
 private:
   int state;
   int beingEdited;
   time_t lastSetEvents;
   time_t lastDeleteExpired;
+  cMutex indexesMutex; // the indexes are built by whichever thread looks up a timer first
+  cTimerMatchIndex *matchIndex;
+  cTimerSchedule *schedule;
+  bool indexesValid;
+  void Invalidate(void);
+  void BuildIndexes(void);
 public:
   cTimers(void);
+  virtual ~cTimers();
   cTimer *GetTimer(cTimer *Timer);
   cTimer *GetMatch(time_t t);
+       ///< Returns the timer that shall start recording at time t. Only the timers
+       ///< that are (or may be) due at t are looked at. The others are kept in a
+       ///< queue ordered by the time at which they become due.
   cTimer *GetMatch(const cEvent *Event, eTimerMatch *Match = NULL);
+       ///< Returns the timer that matches the given Event best. Only the timers
+       ///< on the Event's channel that may overlap it are looked at, using an
+       ///< index that is rebuilt after the timers have been modified (which
+       ///< includes any change of a timer's times or flags through its Set...()
+       ///< functions).
   cTimer *GetNextActiveTimer(void);
+       ///< Returns the active timer with the earliest start time that hasn't ended
+       ///< yet, or NULL if there is no such timer.
   int BeingEdited(void) { return beingEdited; }
   void IncBeingEdited(void) { beingEdited++; }
   void DecBeingEdited(void) { if (!--beingEdited) lastSetEvents = 0; }
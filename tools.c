@@ -1885,11 +1885,37 @@ void cLockFile::Unlock(void)
      }
 }
 
+// --- cListIndex ------------------------------------------------------------
+
+class cListIndex {
+public:
+  cMutex mutex;
+  cListObject **objects;
+  int size;
+  int allocated;
+  bool valid;
+  cListIndex(void) { objects = NULL; size = allocated = 0; valid = false; }
+  ~cListIndex() { free(objects); }
+  void Append(cListObject *Object);
+  };
+
+void cListIndex::Append(cListObject *Object)
+{
+  if (size >= allocated) {
+     allocated = max(allocated * 2, 64);
+     objects = (cListObject **)realloc(objects, allocated * sizeof(cListObject *));
+     }
+  Object->position = size;
+  objects[size++] = Object;
+}
+
 // --- cListObject -----------------------------------------------------------
 
 cListObject::cListObject(void)
 {
   prev = next = NULL;
+  list = NULL;
+  position = -1;
 }
 
 cListObject::~cListObject()
@@ -1919,6 +1945,12 @@ void cListObject::Unlink(void)
 
 int cListObject::Index(void) const
 {
+  if (list && list->index) {
+     cMutexLock MutexLock(&list->index->mutex);
+     list->BuildIndex();
+     if (position >= 0 && position < list->index->size && list->index->objects[position] == this)
+        return position;
+     }
   cListObject *p = prev;
   int i = 0;
 
@@ -1933,6 +1965,7 @@ int cListObject::Index(void) const
 
 cListBase::cListBase(void)
 {
+  index = NULL;
   objects = lastObject = NULL;
   count = 0;
 }
@@ -1940,6 +1973,34 @@ cListBase::cListBase(void)
 cListBase::~cListBase()
 {
   Clear();
+  delete index;
+}
+
+void cListBase::SetIndexed(bool On)
+{
+  if (On && !index)
+     index = new cListIndex;
+  else if (!On)
+     DELETENULL(index);
+}
+
+void cListBase::BuildIndex(void) const
+{
+  // index->mutex must be locked!
+  if (!index->valid) {
+     index->size = 0;
+     for (cListObject *object = objects; object; object = object->Next())
+         index->Append(object);
+     index->valid = true;
+     }
+}
+
+void cListBase::InvalidateIndex(void)
+{
+  if (index) {
+     cMutexLock MutexLock(&index->mutex);
+     index->valid = false;
+     }
 }
 
 void cListBase::Add(cListObject *Object, cListObject *After)
@@ -1947,6 +2008,7 @@ void cListBase::Add(cListObject *Object, cListObject *After)
   if (After && After != lastObject) {
      After->Next()->Insert(Object);
      After->Append(Object);
+     InvalidateIndex();
      }
   else {
      if (lastObject)
@@ -1954,7 +2016,13 @@ void cListBase::Add(cListObject *Object, cListObject *After)
      else
         objects = Object;
      lastObject = Object;
+     if (index) {
+        cMutexLock MutexLock(&index->mutex);
+        if (index->valid)
+           index->Append(Object);
+        }
      }
+  Object->list = this;
   count++;
 }
 
@@ -1971,6 +2039,8 @@ void cListBase::Ins(cListObject *Object, cListObject *Before)
         lastObject = Object;
      objects = Object;
      }
+  Object->list = this;
+  InvalidateIndex();
   count++;
 }
 
@@ -1981,6 +2051,8 @@ void cListBase::Del(cListObject *Object, bool DeleteObject)
   if (Object == lastObject)
      lastObject = Object->Prev();
   Object->Unlink();
+  Object->list = NULL;
+  InvalidateIndex();
   if (DeleteObject)
      delete Object;
   count--;
@@ -2012,6 +2084,7 @@ void cListBase::Move(cListObject *From, cListObject *To)
         }
      if (!From->Prev())
         objects = From;
+     InvalidateIndex();
      }
 }
 
@@ -2024,12 +2097,18 @@ void cListBase::Clear(void)
         }
   objects = lastObject = NULL;
   count = 0;
+  InvalidateIndex();
 }
 
 cListObject *cListBase::Get(int Index) const
 {
   if (Index < 0)
      return NULL;
+  if (index) {
+     cMutexLock MutexLock(&index->mutex);
+     BuildIndex();
+     return Index < index->size ? index->objects[Index] : NULL;
+     }
   cListObject *object = objects;
   while (object && Index-- > 0)
         object = object->Next();
@@ -2055,6 +2134,7 @@ void cListBase::Sort(void)
         }
   qsort(a, n, sizeof(cListObject *), CompareListObjects);
   objects = lastObject = NULL;
+  InvalidateIndex();
   for (i = 0; i < n; i++) {
       a[i]->Unlink();
       count--;
@@ -2121,3 +2201,91 @@ cList<cHashObject> *cHashBase::GetList(unsigned int Id) const
 {
   return hashTable[hashfn(Id)];
 }
+
+// --- cOpenHashBase ---------------------------------------------------------
+
+#define OPENHASHDELETED ((cListObject *)-1) // marks an entry that has been deleted
+
+cOpenHashBase::cOpenHashBase(int Size)
+{
+  hashTable = NULL;
+  size = shift = count = used = 0;
+  Resize(Size);
+}
+
+cOpenHashBase::~cOpenHashBase(void)
+{
+  free(hashTable);
+}
+
+void cOpenHashBase::Resize(int NewSize)
+{
+  int Bits = 2;
+  while ((1 << Bits) < NewSize)
+        Bits++;
+  tOpenHashEntry *OldTable = hashTable;
+  int OldSize = size;
+  size = 1 << Bits;
+  shift = 32 - Bits;
+  hashTable = (tOpenHashEntry *)calloc(size, sizeof(tOpenHashEntry));
+  count = used = 0;
+  for (int i = 0; i < OldSize; i++) {
+      if (OldTable[i].object && OldTable[i].object != OPENHASHDELETED)
+         Add(OldTable[i].object, OldTable[i].id);
+      }
+  free(OldTable);
+}
+
+void cOpenHashBase::Add(cListObject *Object, unsigned int Id)
+{
+  if ((used + 1) * 4 > size * 3) // keeps the load factor below 75%
+     Resize((count + 1) * 2 > size ? size * 2 : size); // a table with many deleted entries is just cleaned up
+  unsigned int i = hashfn(Id);
+  while (hashTable[i].object && hashTable[i].object != OPENHASHDELETED)
+        i = (i + 1) & (size - 1);
+  if (!hashTable[i].object)
+     used++;
+  hashTable[i].id = Id;
+  hashTable[i].object = Object;
+  count++;
+}
+
+void cOpenHashBase::Del(cListObject *Object, unsigned int Id)
+{
+  for (unsigned int i = hashfn(Id); hashTable[i].object; i = (i + 1) & (size - 1)) {
+      if (hashTable[i].object == Object) {
+         hashTable[i].object = OPENHASHDELETED;
+         count--;
+         break;
+         }
+      }
+}
+
+void cOpenHashBase::Clear(void)
+{
+  memset(hashTable, 0, size * sizeof(tOpenHashEntry));
+  count = used = 0;
+}
+
+cListObject *cOpenHashBase::Get(unsigned int Id) const
+{
+  int Slot;
+  return First(Id, Slot);
+}
+
+cListObject *cOpenHashBase::First(unsigned int Id, int &Slot) const
+{
+  Slot = hashfn(Id) - 1;
+  return Next(Id, Slot);
+}
+
+cListObject *cOpenHashBase::Next(unsigned int Id, int &Slot) const
+{
+  for (unsigned int i = (Slot + 1) & (size - 1); hashTable[i].object; i = (i + 1) & (size - 1)) {
+      if (hashTable[i].id == Id && hashTable[i].object != OPENHASHDELETED) {
+         Slot = i;
+         return hashTable[i].object;
+         }
+      }
+  return NULL;
+}
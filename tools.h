@@ -441,9 +441,15 @@ public:
   void Unlock(void);
   };
 
+class cListBase;
+
 class cListObject {
+  friend class cListBase;
+  friend class cListIndex;
 private:
   cListObject *prev, *next;
+  cListBase *list; // the list this object is in (if any)
+  int position; // this object's position in an indexed list
 public:
   cListObject(void);
   virtual ~cListObject();
@@ -458,13 +464,28 @@ public:
   cListObject *Next(void) const { return next; }
   };
 
+class cListIndex;
+
 class cListBase {
+  friend class cListObject;
+private:
+  cListIndex *index;
+  void BuildIndex(void) const;
+  void InvalidateIndex(void);
 protected:
   cListObject *objects, *lastObject;
   cListBase(void);
   int count;
 public:
   virtual ~cListBase();
+  void SetIndexed(bool On = true);
+       ///< Turns on (or off) an index of the objects in this list, which makes
+       ///< Get() and cListObject::Index() take constant instead of linear time.
+       ///< The index is built when it is first needed, and is rebuilt the next
+       ///< time it is needed after the list has been modified (objects added at
+       ///< the end of the list are appended to it right away). This is meant for
+       ///< long lists that are accessed by position, like menus, recordings,
+       ///< timers and channels.
   void Add(cListObject *Object, cListObject *After = NULL);
   void Ins(cListObject *Object, cListObject *Before = NULL);
   void Del(cListObject *Object, bool DeleteObject = true);
@@ -551,7 +572,7 @@ public:
   virtual void Remove(int Index)
   {
     if (Index < size - 1)
-       memmove(&data[Index], &data[Index + 1], (size - Index) * sizeof(T));
+       memmove(&data[Index], &data[Index + 1], (size - Index - 1) * sizeof(T));
     size--;
   }
   virtual void Clear(void)
@@ -631,4 +652,52 @@ public:
   T *Get(unsigned int Id) const { return (T *)cHashBase::Get(Id); }
 };
 
+class cOpenHashBase {
+private:
+  struct tOpenHashEntry {
+    unsigned int id;
+    cListObject *object;
+    };
+  tOpenHashEntry *hashTable;
+  int size; // always a power of 2
+  int shift;
+  int count; // the number of objects in the table
+  int used; // count plus the number of deleted entries
+  unsigned int hashfn(unsigned int Id) const { return (Id * 2654435769U) >> shift; }
+  void Resize(int NewSize);
+protected:
+  cOpenHashBase(int Size);
+public:
+  virtual ~cOpenHashBase();
+  void Add(cListObject *Object, unsigned int Id);
+  void Del(cListObject *Object, unsigned int Id);
+  void Clear(void);
+  cListObject *Get(unsigned int Id) const;
+  cListObject *First(unsigned int Id, int &Slot) const;
+       ///< Returns the first object with the given Id (or NULL if there is none)
+       ///< and sets Slot so that Next() continues from there. Use this instead of
+       ///< Get() if there can be several objects with the same Id.
+  cListObject *Next(unsigned int Id, int &Slot) const;
+       ///< Returns the next object with the given Id after the one previously
+       ///< returned by First() or Next(), or NULL if there are no more.
+  int Count(void) const { return count; }
+  };
+
+#define OPENHASHSIZE 16
+
+/// cOpenHash is a hash table that stores its entries directly in an array
+/// ("open addressing"), which grows as objects are added. Unlike cHash it
+/// needs no memory allocation per object, and its access time doesn't degrade
+/// with the number of objects, which makes it suitable for large tables like
+/// the events of an EPG. The table must not be modified while iterating over
+/// it with First()/Next().
+
+template<class T> class cOpenHash : public cOpenHashBase {
+public:
+  cOpenHash(int Size = OPENHASHSIZE) : cOpenHashBase(Size) {}
+  T *Get(unsigned int Id) const { return (T *)cOpenHashBase::Get(Id); }
+  T *First(unsigned int Id, int &Slot) const { return (T *)cOpenHashBase::First(Id, Slot); }
+  T *Next(unsigned int Id, int &Slot) const { return (T *)cOpenHashBase::Next(Id, Slot); }
+};
+
 #endif //__TOOLS_H
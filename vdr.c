@@ -698,6 +698,7 @@ int main(int argc, char *argv[])
 
   // Recordings:
 
+  cRecordings::SetCacheFileName(AddDirectory(CacheDirectory, "recordings.cache"));
   Recordings.Update();
   DeletedRecordings.Update();
 
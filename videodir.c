@@ -34,6 +34,7 @@ public:
   cVideoDirectory(void);
   ~cVideoDirectory();
   int FreeMB(int *UsedMB = NULL);
+  dev_t Device(void);
   const char *Name(void) { return name ? name : VideoDirectory; }
   const char *Stored(void) { return stored; }
   int Length(void) { return length; }
@@ -64,6 +65,14 @@ int cVideoDirectory::FreeMB(int *UsedMB)
   return FreeDiskSpaceMB(name ? name : VideoDirectory, UsedMB);
 }
 
+dev_t cVideoDirectory::Device(void)
+{
+  struct stat st;
+  if (stat(Name(), &st) == 0)
+     return st.st_dev;
+  return 0;
+}
+
 bool cVideoDirectory::Next(void)
 {
   if (name) {
@@ -108,6 +117,61 @@ const char *cVideoDirectory::Adjust(const char *FileName)
   return NULL;
 }
 
+// --- cVideoFileWriters -----------------------------------------------------
+
+// Keeps track of the video files that are currently being written, so that
+// new files can be placed on the disks that have the least write load.
+
+class cVideoFileWriters {
+private:
+  static cMutex mutex;
+  static cVector<cUnbufferedFile *> files;
+  static cVector<dev_t> devices;
+public:
+  static void Add(cUnbufferedFile *File, const char *FileName);
+  static void Del(cUnbufferedFile *File);
+  static int Count(dev_t Dev);
+  };
+
+cMutex cVideoFileWriters::mutex;
+cVector<cUnbufferedFile *> cVideoFileWriters::files;
+cVector<dev_t> cVideoFileWriters::devices;
+
+void cVideoFileWriters::Add(cUnbufferedFile *File, const char *FileName)
+{
+  struct stat st;
+  if (stat(FileName, &st) == 0) {
+     cMutexLock MutexLock(&mutex);
+     files.Append(File);
+     devices.Append(st.st_dev);
+     }
+}
+
+void cVideoFileWriters::Del(cUnbufferedFile *File)
+{
+  cMutexLock MutexLock(&mutex);
+  for (int i = 0; i < files.Size(); i++) {
+      if (files[i] == File) {
+         files.Remove(i);
+         devices.Remove(i);
+         break;
+         }
+      }
+}
+
+int cVideoFileWriters::Count(dev_t Dev)
+{
+  cMutexLock MutexLock(&mutex);
+  int n = 0;
+  for (int i = 0; i < devices.Size(); i++) {
+      if (devices[i] == Dev)
+         n++;
+      }
+  return n;
+}
+
+// --- Video files -----------------------------------------------------------
+
 cUnbufferedFile *OpenVideoFile(const char *FileName, int Flags)
 {
   const char *ActualFileName = FileName;
@@ -119,19 +183,33 @@ cUnbufferedFile *OpenVideoFile(const char *FileName, int Flags)
      return NULL;
      }
   // Are we going to create a new file?
+  bool Distributed = false;
   if ((Flags & O_CREAT) != 0) {
      cVideoDirectory Dir;
      if (Dir.IsDistributed()) {
-        // Find the directory with the most free space:
+        // Find the directory on the disk with the fewest files currently being
+        // written (so that simultaneous recordings are spread over all disks),
+        // and among these the one with the most free space. Since every file of
+        // a recording is placed separately, a long recording is also spread over
+        // several disks. Disks that don't have room for a file of the maximum
+        // size are only used if all disks are that full:
+        Distributed = true;
+        int MinFree = Setup.MaxVideoFileSize;
         int MaxFree = Dir.FreeMB();
+        int MinWriters = cVideoFileWriters::Count(Dir.Device());
         while (Dir.Next()) {
               int Free = FreeDiskSpaceMB(Dir.Name());
-              if (Free > MaxFree) {
+              int Writers = cVideoFileWriters::Count(Dir.Device());
+              bool Room = Free >= MinFree;
+              bool MaxRoom = MaxFree >= MinFree;
+              if (Room && !MaxRoom || Room == MaxRoom && (Writers < MinWriters || Writers == MinWriters && Free > MaxFree)) {
                  Dir.Store();
                  MaxFree = Free;
+                 MinWriters = Writers;
                  }
               }
         if (Dir.Stored()) {
+           dsyslog("placing '%s' on %s (%d MB free, %d file%s being written)", FileName, Dir.Stored(), MaxFree, MinWriters, MinWriters == 1 ? "" : "s");
            ActualFileName = Dir.Adjust(FileName);
            if (!MakeDirs(ActualFileName, false))
               return NULL; // errno has been set by MakeDirs()
@@ -144,6 +222,8 @@ cUnbufferedFile *OpenVideoFile(const char *FileName, int Flags)
         }
      }
   cUnbufferedFile *File = cUnbufferedFile::Create(ActualFileName, Flags, DEFFILEMODE);
+  if (File && Distributed)
+     cVideoFileWriters::Add(File, ActualFileName);
   if (ActualFileName != FileName)
      free((char *)ActualFileName);
   return File;
@@ -151,6 +231,7 @@ cUnbufferedFile *OpenVideoFile(const char *FileName, int Flags)
 
 int CloseVideoFile(cUnbufferedFile *File)
 {
+  cVideoFileWriters::Del(File);
   int Result = File->Close();
   delete File;
   return Result;